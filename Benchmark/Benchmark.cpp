@@ -0,0 +1,462 @@
+#include "BenchmarkRunner.h"
+#include "CalendarGenerator.h"
+#include "../Scheduler.h"
+#include "../Day.h"
+#include "../Event.h"
+#include "../ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+/*
+ * Benchmarks of the calendar, run on a calendar from CalendarGenerator:
+ *
+ *     Benchmark [options]                      runs the benchmarks and writes the results as JSON
+ *     Benchmark generate <file> [options]      only writes the generated calendar
+ *
+ * Options: --days n, --events-per-day x, --series n, --seed n, --min-time seconds, --filter text,
+ * --readers n (most reader threads for the concurrent reads), --dir path (scratch files), --output file.
+ */
+
+static volatile int sink; // results are added up here, so that the compiler cannot drop the work that made them
+
+struct BenchmarkOptions {
+    GeneratorSettings calendar;
+    double minimumSeconds;
+    string filter;
+    int maxReaders;
+    string directory;
+    string outputPath;
+    string generatePath;
+
+    BenchmarkOptions() : minimumSeconds(0.2), maxReaders(4), directory(".") {}
+};
+
+struct ScratchFiles { // files written next to each other in the scratch directory, removed when the run ends
+    string calendar; // the generated text file
+    string exportPath;
+    string icsPath; // the calendar exported as iCalendar
+    string emptyData; // data path of a calendar that starts out empty
+    string data; // data path of the calendar that is changed by the benchmarks
+
+    ScratchFiles(const string& directory) {
+        calendar = directory + "/benchmark-calendar.txt";
+        exportPath = directory + "/benchmark-export.txt";
+        icsPath = directory + "/benchmark-export.ics";
+        emptyData = directory + "/benchmark-empty";
+        data = directory + "/benchmark-data";
+    }
+
+    void removeAll() const {
+        for (const string& path : { calendar, exportPath, icsPath, emptyData + ".txt", emptyData + ".bin", emptyData + ".journal", data + ".txt", data + ".bin", data + ".journal" }) {
+            remove(path.c_str());
+        }
+    }
+};
+
+static bool copyFile(const string& from, const string& to) {
+    ifstream source(from, ios::binary);
+    ofstream target(to, ios::binary);
+    target << source.rdbuf();
+    return source && target;
+}
+
+static void requireOk(const Status& status, const string& benchmark) { // a benchmark that fails would time the wrong thing
+    if (!status.isOk()) {
+        cerr << benchmark << ": " << status.message() << "\n";
+        exit(1);
+    }
+}
+
+static void requireStored(const Expected<vector<Conflict>>& conflicts, const string& benchmark) {
+    requireOk(conflicts.error(), benchmark);
+    if (!conflicts->empty()) {
+        cerr << benchmark << ": conflicts with " << conflicts->front().title << "\n";
+        exit(1);
+    }
+}
+
+static void runEventBenchmarks(BenchmarkRunner& runner) {
+    vector<Event> events; // pairs of random events, about a quarter of them overlap
+    uint32_t random = 12345;
+    for (int i = 0; i < 4096; ++i) {
+        random = random * 1664525 + 1013904223;
+        int start = 15 * (int)((random >> 8) % 88); // 00:00 to 21:45
+        int duration = 15 * (1 + (int)((random >> 20) % 8));
+        events.push_back(Event(Title("Meeting"), Time::fromMinutes(start), Time::fromMinutes(start + duration)));
+    }
+    runner.measure("Event::overlaps", [&events](int64_t iterations, Stopwatch& stopwatch) {
+        int overlapping = 0;
+        stopwatch.start();
+        for (int64_t i = 0; i < iterations; ++i) {
+            overlapping += events[i & 4095].overlaps(events[(i * 7 + 1) & 4095]);
+        }
+        stopwatch.stop();
+        sink += overlapping;
+    });
+
+    vector<Event> dayEvents; // a full day of 30 minute meetings from 06:00 to 22:00
+    for (int i = 0; i < 32; ++i) {
+        dayEvents.push_back(Event(Title("Meeting " + to_string(i)), Time::fromMinutes(360 + 30 * i), Time::fromMinutes(390 + 30 * i)));
+    }
+    vector<Event> shuffled = dayEvents;
+    for (int i = 31; i > 0; --i) {
+        random = random * 1664525 + 1013904223;
+        swap(shuffled[i], shuffled[(random >> 8) % (i + 1)]);
+    }
+
+    runner.measure("Day::addEvent, 32 events in random order", [&shuffled](int64_t iterations, Stopwatch& stopwatch) {
+        Day day(0);
+        stopwatch.start();
+        for (int64_t i = 0; i < iterations; ++i) {
+            if (i % 32 == 0) {
+                day.clearEvents();
+            }
+            day.addEvent(shuffled[i % 32]);
+        }
+        stopwatch.stop();
+        sink += (int)day.events.size();
+    });
+    runner.measure("Day::appendEvent, 32 events in order", [&dayEvents](int64_t iterations, Stopwatch& stopwatch) {
+        Day day(0);
+        stopwatch.start();
+        for (int64_t i = 0; i < iterations; ++i) {
+            if (i % 32 == 0) {
+                day.clearEvents();
+            }
+            day.appendEvent(dayEvents[i % 32]);
+        }
+        stopwatch.stop();
+        sink += (int)day.events.size();
+    });
+
+    Day fullDay(0);
+    for (const Event& event : dayEvents) {
+        fullDay.appendEvent(event);
+    }
+    runner.measure("Day::tryAddEvent, rejected overlap", [&fullDay, &events](int64_t iterations, Stopwatch& stopwatch) {
+        int rejected = 0;
+        stopwatch.start();
+        for (int64_t i = 0; i < iterations; ++i) {
+            rejected += !fullDay.tryAddEvent(events[i & 4095]).isOk();
+        }
+        stopwatch.stop();
+        sink += rejected;
+    });
+    runner.measure("Day::findEvent", [&fullDay, &dayEvents](int64_t iterations, Stopwatch& stopwatch) {
+        int found = 0;
+        stopwatch.start();
+        for (int64_t i = 0; i < iterations; ++i) {
+            found += (fullDay.findEvent(dayEvents[i % 32].title) != nullptr);
+        }
+        stopwatch.stop();
+        sink += found;
+    });
+}
+
+static void runFileBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options, const ScratchFiles& files, double lineCount) {
+    int firstDay = options.calendar.firstDay;
+
+    runner.measure("Scheduler::loadEventsFrom_txt", [&](int64_t iterations, Stopwatch& stopwatch) {
+        for (int64_t i = 0; i < iterations; ++i) {
+            Scheduler scheduler(firstDay, files.emptyData, true);
+            stopwatch.start();
+            scheduler.loadEventsFrom_txt(files.calendar);
+            stopwatch.stop();
+        }
+    }, lineCount);
+
+    Scheduler loaded(firstDay, files.emptyData, true);
+    loaded.loadEventsFrom_txt(files.calendar);
+    runner.measure("Scheduler::saveEventsTo_txt", [&]() {
+        loaded.saveEventsTo_txt(files.exportPath);
+    }, lineCount);
+
+    runner.measure("Scheduler::saveEventsTo_ics", [&]() { // one VEVENT per line of the text file
+        loaded.saveEventsTo_ics(files.icsPath);
+    }, lineCount);
+    runner.measure("Scheduler::importFrom_ics", [&](int64_t iterations, Stopwatch& stopwatch) {
+        for (int64_t i = 0; i < iterations; ++i) {
+            Scheduler scheduler(firstDay, files.emptyData, true);
+            stopwatch.start();
+            sink += (int)scheduler.importFrom_ics(files.icsPath).size();
+            stopwatch.stop();
+        }
+    }, lineCount);
+
+    ThreadPool pool;
+    runner.measure("Scheduler::bulkImportFrom_txt, " + to_string(pool.size()) + " threads", [&](int64_t iterations, Stopwatch& stopwatch) {
+        for (int64_t i = 0; i < iterations; ++i) {
+            Scheduler scheduler(firstDay, files.emptyData, true);
+            stopwatch.start();
+            sink += (int)scheduler.bulkImportFrom_txt(files.calendar, pool).size();
+            stopwatch.stop();
+        }
+    }, lineCount);
+
+    int lastDay = firstDay + options.calendar.dayCount - 1;
+    runner.measure("Scheduler::daySchedule, series merged in", [&](int64_t iterations, Stopwatch& stopwatch) {
+        int shown = 0;
+        stopwatch.start();
+        for (int64_t i = 0; i < iterations; ++i) {
+            shown += (int)loaded.daySchedule(firstDay + (int)(i % (lastDay - firstDay + 1))).events.size();
+        }
+        stopwatch.stop();
+        sink += shown;
+    });
+}
+
+static void runSchedulingBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options, const ScratchFiles& files) {
+    int firstDay = options.calendar.firstDay;
+    int lastDay = firstDay + options.calendar.dayCount - 1;
+    copyFile(files.calendar, files.data + ".txt");
+    Scheduler scheduler(firstDay, files.data); // imports the text file and writes the snapshot
+
+    runner.measure("Scheduler::compact, nothing changed", [&]() {
+        scheduler.compact();
+    });
+    runner.measure("Scheduler constructor, snapshot load", [&]() {
+        Scheduler reader(firstDay, files.data, true);
+        sink += (int)reader.daySchedule(firstDay).events.size();
+    });
+
+    vector<int> workingDays; // the changes below are made on days that are not off
+    for (int date = firstDay; date <= lastDay; ++date) {
+        if (!scheduler.daySchedule(date).isDayOff) {
+            workingDays.push_back(date);
+        }
+    }
+    if (workingDays.empty()) {
+        return;
+    }
+
+    // 23:30 to 23:55 is free on every day of a generated calendar, so each schedule is stored and each cancel removes it again
+    Event late(Title("Benchmark"), Time(23, 30), Time(23, 55));
+    const char* repeats[] = { "single event", "daily series", "weekly series" };
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        string name = string("Scheduler::trySchedule and tryCancel, ") + repeats[repeat];
+        Event event(late.title, late.startTime, late.endTime, (RepeatType)repeat);
+        runner.measure(name, [&](int64_t iterations, Stopwatch& stopwatch) {
+            stopwatch.start();
+            for (int64_t i = 0; i < iterations; ++i) {
+                int date = workingDays[i % workingDays.size()];
+                requireStored(scheduler.trySchedule(date, event, false), name);
+                requireOk(scheduler.tryCancel(date, "Benchmark", true), name);
+            }
+            stopwatch.stop();
+        });
+    }
+
+    Event lateSingle(late.title, late.startTime, late.endTime);
+    int changedDay = workingDays[workingDays.size() / 2];
+    runner.measure("Scheduler::compact, one day changed", [&](int64_t iterations, Stopwatch& stopwatch) { // only the segment of the day is written again
+        for (int64_t i = 0; i < iterations; ++i) {
+            requireStored(scheduler.trySchedule(changedDay, lateSingle, false), "Scheduler::compact, one day changed");
+            stopwatch.start();
+            scheduler.compact();
+            stopwatch.stop();
+            requireOk(scheduler.tryCancel(changedDay, "Benchmark", false), "Scheduler::compact, one day changed"); // saved by the next compact
+        }
+    });
+
+    runner.measure("Scheduler::renderMonthSchedule, nothing changed", [&]() { // copied out of the render cache
+        Renderer frame;
+        scheduler.renderMonthSchedule(changedDay, frame);
+        sink += (int)frame.text().size();
+    });
+    requireStored(scheduler.trySchedule(changedDay, lateSingle, false), "Scheduler::renderMonthSchedule, after rejected commands");
+    runner.measure("Scheduler::renderMonthSchedule, after rejected commands", [&](int64_t iterations, Stopwatch& stopwatch) { // still copied out of the render cache
+        Renderer first;
+        scheduler.renderMonthSchedule(changedDay, first);
+        uint64_t builtViews = scheduler.builtViews();
+        for (int64_t i = 0; i < iterations; ++i) {
+            Expected<vector<Conflict>> overlapping = scheduler.trySchedule(changedDay, lateSingle, false);
+            if ((overlapping.error().isOk() && overlapping->empty()) || scheduler.tryCancel(changedDay, "Missing", false).isOk()
+                || scheduler.tryShift(changedDay, "Missing", changedDay + 1).isOk()) {
+                cerr << "Scheduler::renderMonthSchedule, after rejected commands: a command was not rejected\n";
+                exit(1);
+            }
+            Renderer frame;
+            stopwatch.start();
+            scheduler.renderMonthSchedule(changedDay, frame);
+            stopwatch.stop();
+            sink += (int)frame.text().size();
+        }
+        if (scheduler.builtViews() != builtViews) { // a rejected command must leave the days and series unstamped
+            cerr << "Scheduler::renderMonthSchedule, after rejected commands: the view was built again\n";
+            exit(1);
+        }
+    });
+    requireOk(scheduler.tryCancel(changedDay, "Benchmark", false), "Scheduler::renderMonthSchedule, after rejected commands");
+    runner.measure("Scheduler::renderMonthSchedule, one day changed", [&](int64_t iterations, Stopwatch& stopwatch) { // only the changed day is formatted again
+        for (int64_t i = 0; i < iterations; ++i) {
+            requireStored(scheduler.trySchedule(changedDay, lateSingle, false), "Scheduler::renderMonthSchedule, one day changed");
+            Renderer frame;
+            stopwatch.start();
+            scheduler.renderMonthSchedule(changedDay, frame);
+            stopwatch.stop();
+            sink += (int)frame.text().size();
+            requireOk(scheduler.tryCancel(changedDay, "Benchmark", false), "Scheduler::renderMonthSchedule, one day changed");
+        }
+    });
+
+    runner.measure("Scheduler::trySaveVersion", [&]() {
+        requireOk(scheduler.trySaveVersion("benchmark"), "Scheduler::trySaveVersion");
+    });
+    requireStored(scheduler.trySchedule(changedDay, lateSingle, false), "Scheduler::tryUndo and tryRedo, one day");
+    runner.measure("Scheduler::tryUndo and tryRedo, one day", [&]() { // each one saves the day into the snapshot
+        requireOk(scheduler.tryUndo(), "Scheduler::tryUndo and tryRedo, one day");
+        requireOk(scheduler.tryRedo(), "Scheduler::tryUndo and tryRedo, one day");
+    });
+    requireOk(scheduler.tryCancel(changedDay, "Benchmark", false), "Scheduler::tryUndo and tryRedo, one day");
+
+    Event workingHours(Title("Benchmark"), Time(8, 0), Time(18, 0), RepeatType::Weekly);
+    runner.measure("Scheduler::trySchedule, weekly series rejected", [&](int64_t iterations, Stopwatch& stopwatch) {
+        size_t conflictCount = 0;
+        stopwatch.start();
+        for (int64_t i = 0; i < iterations; ++i) {
+            Expected<vector<Conflict>> conflicts = scheduler.trySchedule(workingDays[i % workingDays.size()], workingHours, false);
+            conflictCount += conflicts.hasValue() ? conflicts->size() : 0;
+        }
+        stopwatch.stop();
+        sink += (int)conflictCount;
+    });
+
+    // The views read the published calendar while one writer keeps scheduling and cancelling
+    scheduler.enableConcurrentReads();
+    for (int readers = 1; readers <= options.maxReaders; ++readers) {
+        string name = "Scheduler::daySchedule, " + to_string(readers) + " readers during writes";
+        if (!runner.isSelected(name)) {
+            continue;
+        }
+        atomic<bool> stopping(false);
+        atomic<int64_t> reads(0);
+        atomic<int64_t> shownEvents(0); // added to sink once the readers are joined, sink is not atomic
+        vector<thread> threads;
+        for (int reader = 0; reader < readers; ++reader) {
+            threads.emplace_back([&, reader]() {
+                int64_t count = 0;
+                int shown = 0;
+                while (!stopping.load(memory_order_relaxed)) {
+                    shown += (int)scheduler.daySchedule(workingDays[(count * 7 + reader) % workingDays.size()]).events.size();
+                    ++count;
+                }
+                reads += count;
+                shownEvents += shown;
+            });
+        }
+
+        int64_t writes = 0;
+        Stopwatch stopwatch;
+        stopwatch.start();
+        auto started = chrono::steady_clock::now();
+        while (chrono::steady_clock::now() - started < chrono::duration<double>(options.minimumSeconds)) {
+            int date = workingDays[writes % workingDays.size()];
+            requireStored(scheduler.trySchedule(date, late, false), name);
+            requireOk(scheduler.tryCancel(date, "Benchmark", false), name);
+            ++writes;
+        }
+        stopping = true;
+        for (thread& reader : threads) {
+            reader.join();
+        }
+        stopwatch.stop();
+        sink += (int)shownEvents.load();
+
+        double seconds = stopwatch.seconds();
+        runner.addResult({ name, reads.load(), seconds * 1e9 / max<int64_t>(reads.load(), 1), reads.load() / seconds, 0 });
+        runner.addResult({ "Scheduler::trySchedule and tryCancel, writer beside " + to_string(readers) + " readers", writes, seconds * 1e9 / max<int64_t>(writes, 1), writes / seconds, 0 });
+    }
+}
+
+static bool parseOptions(int argc, char* argv[], BenchmarkOptions& options) {
+    int i = 1;
+    if (argc > 2 && string(argv[1]) == "generate") {
+        options.generatePath = argv[2];
+        i = 3;
+    }
+    for (; i < argc; ++i) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (option == "--days") {
+            options.calendar.dayCount = atoi(value);
+        }
+        else if (option == "--events-per-day") {
+            options.calendar.eventsPerDay = atof(value);
+        }
+        else if (option == "--series") {
+            options.calendar.seriesCount = atoi(value);
+        }
+        else if (option == "--seed") {
+            options.calendar.seed = (uint32_t)strtoul(value, nullptr, 10);
+        }
+        else if (option == "--min-time") {
+            options.minimumSeconds = atof(value);
+        }
+        else if (option == "--filter") {
+            options.filter = value;
+        }
+        else if (option == "--readers") {
+            options.maxReaders = atoi(value);
+        }
+        else if (option == "--dir") {
+            options.directory = value;
+        }
+        else if (option == "--output") {
+            options.outputPath = value;
+        }
+        else {
+            return false;
+        }
+    }
+    return options.calendar.dayCount > 0 && options.calendar.eventsPerDay >= 0 && options.calendar.seriesCount >= 0 && options.minimumSeconds > 0;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "Usage: Benchmark [generate <file>] [--days n] [--events-per-day x] [--series n] [--seed n] [--min-time seconds] [--filter text] [--readers n] [--dir path] [--output file]\n";
+        return 2;
+    }
+
+    CalendarGenerator generator(options.calendar);
+    if (!options.generatePath.empty()) {
+        return generator.writeTo(options.generatePath) ? 0 : 1;
+    }
+
+    ScratchFiles files(options.directory);
+    string calendar = generator.generate();
+    double lineCount = (double)count(calendar.begin(), calendar.end(), '\n');
+    if (!generator.writeTo(files.calendar) || !ofstream(files.emptyData + ".txt")) {
+        cerr << "Cannot write to " << options.directory << "\n";
+        return 1;
+    }
+
+    BenchmarkRunner runner(options.minimumSeconds, options.filter);
+    runEventBenchmarks(runner);
+    runFileBenchmarks(runner, options, files, lineCount);
+    runSchedulingBenchmarks(runner, options, files);
+    files.removeAll();
+
+    char settings[256];
+    snprintf(settings, sizeof(settings), "{\"days\": %d, \"eventsPerDay\": %.2f, \"series\": %d, \"seed\": %u, \"lines\": %.0f, \"hardwareThreads\": %u}",
+        options.calendar.dayCount, options.calendar.eventsPerDay, options.calendar.seriesCount, options.calendar.seed, lineCount, thread::hardware_concurrency());
+    string json = runner.toJson(settings);
+    if (options.outputPath.empty()) {
+        cout << json;
+        return 0;
+    }
+    ofstream output(options.outputPath);
+    output << json;
+    return output ? 0 : 1;
+}
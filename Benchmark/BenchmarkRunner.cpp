@@ -0,0 +1,75 @@
+#include "BenchmarkRunner.h"
+
+#include <cstdio>
+
+using namespace std;
+
+BenchmarkRunner::BenchmarkRunner(double minimumSeconds, const string& filter) {
+    this->minimumSeconds = minimumSeconds;
+    this->filter = filter;
+}
+
+bool BenchmarkRunner::isSelected(const string& name) const {
+    return filter.empty() || name.find(filter) != string::npos;
+}
+
+void BenchmarkRunner::measure(const string& name, const function<void(int64_t, Stopwatch&)>& batch, double itemsPerOp) {
+    if (!isSelected(name)) {
+        return;
+    }
+    int64_t iterations = 1;
+    while (true) {
+        Stopwatch stopwatch;
+        batch(iterations, stopwatch);
+        double seconds = stopwatch.seconds();
+        if (seconds >= minimumSeconds || iterations >= (int64_t(1) << 40)) {
+            addResult({ name, iterations, seconds * 1e9 / iterations, iterations / seconds, itemsPerOp });
+            return;
+        }
+        double factor = (seconds > 0) ? 1.4 * minimumSeconds / seconds : 10; // aim a little past the minimum so that the next batch is the last
+        iterations = (int64_t)(iterations * (factor < 10 ? factor : 10)) + 1;
+    }
+}
+
+void BenchmarkRunner::measure(const string& name, const function<void()>& operation, double itemsPerOp) {
+    measure(name, [&operation](int64_t iterations, Stopwatch& stopwatch) {
+        stopwatch.start();
+        for (int64_t i = 0; i < iterations; ++i) {
+            operation();
+        }
+        stopwatch.stop();
+    }, itemsPerOp);
+}
+
+void BenchmarkRunner::addResult(const BenchmarkResult& result) {
+    results.push_back(result);
+    fprintf(stderr, "%-64s %12.1f ns/op %14.1f ops/s\n", result.name.c_str(), result.nsPerOp, result.opsPerSecond); // progress, stdout holds the JSON
+}
+
+static string escape(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+string BenchmarkRunner::toJson(const string& settingsJson) const {
+    string json = "{\n  \"settings\": " + settingsJson + ",\n  \"benchmarks\": [";
+    char number[64];
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        json += (i > 0 ? ",\n    " : "\n    ");
+        json += "{\"name\": \"" + escape(result.name) + "\", \"iterations\": " + to_string(result.iterations);
+        snprintf(number, sizeof(number), "%.3f", result.nsPerOp);
+        json += string(", \"nsPerOp\": ") + number;
+        snprintf(number, sizeof(number), "%.3f", result.opsPerSecond);
+        json += string(", \"opsPerSecond\": ") + number;
+        snprintf(number, sizeof(number), "%.3f", result.itemsPerOp);
+        json += string(", \"itemsPerOp\": ") + number + "}";
+    }
+    return json + "\n  ]\n}\n";
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct BenchmarkResult {
+    string name;
+    int64_t iterations;
+    double nsPerOp;
+    double opsPerSecond;
+    double itemsPerOp; // lines, events or days handled by one operation, 0 if it does not apply
+};
+
+class Stopwatch {
+private:
+    chrono::steady_clock::time_point started;
+    double elapsed; // seconds, summed over every start() and stop()
+
+public:
+    Stopwatch() : elapsed(0) {}
+
+    void start() { started = chrono::steady_clock::now(); }
+    void stop() { elapsed += chrono::duration<double>(chrono::steady_clock::now() - started).count(); }
+    double seconds() const { return elapsed; }
+};
+
+/*
+ * Runs each benchmark in growing batches until one batch takes at least the minimum time, and reports the
+ * time of that batch per operation. The results are written as JSON so that runs can be compared by scripts:
+ *
+ *     {"settings": {...}, "benchmarks": [{"name": ..., "iterations": ..., "nsPerOp": ..., "opsPerSecond": ..., "itemsPerOp": ...}]}
+ */
+class BenchmarkRunner {
+private:
+    double minimumSeconds;
+    string filter; // only the benchmarks whose name contains it are run
+    vector<BenchmarkResult> results;
+
+public:
+    BenchmarkRunner(double minimumSeconds = 0.2, const string& filter = "");
+
+    bool isSelected(const string& name) const;
+
+    // The batch runs the operation the given number of times and times only the part that is measured
+    void measure(const string& name, const function<void(int64_t iterations, Stopwatch& stopwatch)>& batch, double itemsPerOp = 0);
+
+    void measure(const string& name, const function<void()>& operation, double itemsPerOp = 0); // every call is timed
+
+    void addResult(const BenchmarkResult& result); // for benchmarks that time themselves
+
+    string toJson(const string& settingsJson) const;
+};
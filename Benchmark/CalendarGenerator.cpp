@@ -0,0 +1,162 @@
+#include "CalendarGenerator.h"
+#include "../Time.h"
+#include "../RecurrenceRule.h"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+static const int WORK_START = 8 * 60;
+static const int WORK_END = 18 * 60;
+static const int DAILY_LANES = 2; // 07:00 and 07:30
+static const int WEEKLY_LANES = 6; // 08:00 to 11:00 on each weekday
+static const int DURATIONS[] = { 15, 30, 30, 30, 45, 60, 60, 90, 120 }; // minutes, short meetings are the common ones
+static const char* const TITLE_NAMES[] = { "Standup", "Review", "1:1", "Planning", "Design sync", "Interview", "Lunch", "Customer call", "Retro", "Demo" };
+
+struct GeneratedSeries {
+    int firstDay;
+    int lastDay; // NO_END is written as an empty field
+    int period;
+    int startMinute;
+    int endMinute;
+    vector<int> exceptions;
+};
+
+GeneratorSettings::GeneratorSettings(int firstDay, int dayCount, double eventsPerDay, int seriesCount) {
+    this->firstDay = firstDay;
+    this->dayCount = dayCount;
+    this->eventsPerDay = eventsPerDay;
+    this->seriesCount = seriesCount;
+    this->dayOffRate = 0.03;
+    this->titleCount = 500;
+    this->seed = 1;
+}
+
+CalendarGenerator::CalendarGenerator(const GeneratorSettings& settings) {
+    this->settings = settings;
+    this->state = settings.seed;
+}
+
+uint32_t CalendarGenerator::nextRandom() { // splitmix64, the same numbers on every platform unlike the standard distributions
+    uint64_t value = (state += 0x9E3779B97F4A7C15ULL);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return (uint32_t)((value ^ (value >> 31)) >> 32);
+}
+
+int CalendarGenerator::randomBelow(int limit) {
+    return limit <= 0 ? 0 : (int)(((uint64_t)nextRandom() * (uint64_t)limit) >> 32);
+}
+
+string CalendarGenerator::title() {
+    double uniform = nextRandom() / 4294967296.0;
+    int index = (int)(uniform * uniform * uniform * settings.titleCount); // cubing leans towards the first titles
+    string name = TITLE_NAMES[index % 10];
+    return index < 10 ? name : name + " " + to_string(index / 10);
+}
+
+string CalendarGenerator::generate() {
+    state = settings.seed;
+    int lastGeneratedDay = settings.firstDay + settings.dayCount - 1;
+
+    // Each series has a half hour lane of its own, so that the series never overlap each other: daily series
+    // before the working day starts, weekly series in the morning, one lane per weekday and half hour. When
+    // there are more series than lanes, the series of a lane follow each other over the generated days.
+    vector<char> daysOff(settings.dayCount); // decided first, so that no series starts on one
+    for (int date = settings.firstDay; date <= lastGeneratedDay; ++date) {
+        int weekday = Date::dayOfWeek(date);
+        daysOff[date - settings.firstDay] = (weekday != 0 && weekday != 6 && randomBelow(1000000) < (int)(settings.dayOffRate * 1000000));
+    }
+
+    vector<GeneratedSeries> series;
+    int dailyCount = settings.seriesCount / 10;
+    int weeklyCount = settings.seriesCount - dailyCount;
+    for (int i = 0; i < settings.seriesCount; ++i) {
+        bool daily = (i < dailyCount);
+        int index = daily ? i : i - dailyCount;
+        int lanes = daily ? DAILY_LANES : WEEKLY_LANES * 7;
+        int lane = index % lanes;
+        int generations = ((daily ? dailyCount : weeklyCount) - lane + lanes - 1) / lanes; // the series that this lane holds
+        int generation = index / lanes;
+
+        GeneratedSeries rule;
+        rule.period = daily ? 1 : 7;
+        int weekday = daily ? 0 : lane % 7;
+        rule.firstDay = settings.firstDay + weekday + rule.period * ((int)((int64_t)generation * settings.dayCount / generations) / rule.period);
+        int nextFirstDay = settings.firstDay + weekday + rule.period * ((int)((int64_t)(generation + 1) * settings.dayCount / generations) / rule.period);
+        while (rule.firstDay <= lastGeneratedDay && daysOff[rule.firstDay - settings.firstDay]) {
+            rule.firstDay += rule.period;
+        }
+        if (rule.firstDay >= nextFirstDay) {
+            continue; // too many series for too few days
+        }
+        bool last = (generation == generations - 1);
+        if (last && randomBelow(3) == 0) {
+            rule.lastDay = RecurrenceRule::NO_END;
+        }
+        else {
+            rule.lastDay = rule.firstDay + randomBelow(max(1, nextFirstDay - rule.firstDay)); // ends before the next series of the lane starts
+        }
+        rule.startMinute = daily ? WORK_START - 30 * (lane + 1) : WORK_START + 30 * (lane / 7);
+        rule.endMinute = rule.startMinute + 30;
+        for (int cancelled = randomBelow(4); cancelled > 0; --cancelled) {
+            rule.exceptions.push_back(rule.firstDay + rule.period * randomBelow(max(1, (min(rule.lastDay, lastGeneratedDay) - rule.firstDay) / rule.period + 1)));
+        }
+        series.push_back(rule);
+    }
+
+    string text;
+    vector<char> busy(24 * 60);
+    for (int date = settings.firstDay; date <= lastGeneratedDay; ++date) {
+        int weekday = Date::dayOfWeek(date);
+        if (weekday == 0 || weekday == 6) {
+            continue;
+        }
+        string dateText = Date::fromDayNumber(date).toString();
+        if (daysOff[date - settings.firstDay]) {
+            text += dateText + "|off|\n";
+            continue;
+        }
+
+        fill(busy.begin(), busy.end(), 0);
+        for (const GeneratedSeries& rule : series) { // the single events keep clear of the series, cancelled or not
+            if (date >= rule.firstDay && date <= rule.lastDay && (date - rule.firstDay) % rule.period == 0) {
+                fill(busy.begin() + rule.startMinute, busy.begin() + rule.endMinute, 1);
+            }
+        }
+
+        int eventCount = (int)(settings.eventsPerDay * (0.5 + randomBelow(1001) / 1000.0) + 0.5);
+        for (int i = 0; i < eventCount; ++i) {
+            for (int attempt = 0; attempt < 4; ++attempt) { // a full day takes fewer events than asked for
+                int duration = DURATIONS[randomBelow(sizeof(DURATIONS) / sizeof(DURATIONS[0]))];
+                int start = WORK_START + 15 * randomBelow((WORK_END - WORK_START - duration) / 15 + 1);
+                if (find(busy.begin() + start, busy.begin() + start + duration, 1) != busy.begin() + start + duration) {
+                    continue;
+                }
+                fill(busy.begin() + start, busy.begin() + start + duration, 1);
+                text += dateText + "|" + title() + "|" + Time::fromMinutes(start).toString() + "|" + Time::fromMinutes(start + duration).toString() + "|none\n";
+                break;
+            }
+        }
+    }
+
+    for (const GeneratedSeries& rule : series) { // written after the days, the way the calendar exports them
+        text += Date::fromDayNumber(rule.firstDay).toString() + "|" + title() + "|" + Time::fromMinutes(rule.startMinute).toString() + "|"
+            + Time::fromMinutes(rule.endMinute).toString() + "|" + (rule.period == 1 ? "daily" : "weekly") + "|"
+            + (rule.lastDay == RecurrenceRule::NO_END ? "" : Date::fromDayNumber(rule.lastDay).toString()) + "|";
+        for (size_t i = 0; i < rule.exceptions.size(); ++i) {
+            text += (i > 0 ? "," : "") + Date::fromDayNumber(rule.exceptions[i]).toString();
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+bool CalendarGenerator::writeTo(const string& path) {
+    ofstream file(path, ios::binary);
+    string text = generate();
+    file.write(text.data(), (streamsize)text.size());
+    return (bool)file;
+}
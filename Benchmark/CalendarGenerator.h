@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "../Date.h"
+
+using namespace std;
+
+struct GeneratorSettings { // Shape of a synthetic calendar
+    int firstDay; // day number of the first generated day
+    int dayCount;
+    double eventsPerDay; // average number of single events on a working day
+    int seriesCount; // daily and weekly series, each with a few cancelled occurrences; fewer if the days cannot take them
+    double dayOffRate; // share of the weekdays that are marked off, weekends hold no meetings
+    int titleCount; // distinct titles the events are drawn from
+    uint32_t seed;
+
+    GeneratorSettings(int firstDay = Date(2024, 7, 1).toDayNumber(), int dayCount = 365, double eventsPerDay = 6, int seriesCount = 20);
+};
+
+/*
+ * Writes calendars in the event text format that look like real ones: meetings in working hours on quarter
+ * hours, lasting 15 minutes to 2 hours and never overlapping, some titles much more common than others, a few
+ * days off, and series that the single events keep clear of. The same settings always give the same file.
+ */
+class CalendarGenerator {
+private:
+    GeneratorSettings settings;
+    uint64_t state;
+
+    uint32_t nextRandom();
+    int randomBelow(int limit);
+    string title(); // a few titles come up often, most of them rarely
+
+public:
+    CalendarGenerator(const GeneratorSettings& settings);
+
+    string generate(); // the whole calendar as text
+    bool writeTo(const string& path); // false if the file cannot be written
+};
@@ -0,0 +1,189 @@
+#include "BulkImporter.h"
+#include "ConflictChecker.h"
+#include "ParseExceptions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+using namespace std;
+
+static const size_t MINIMUM_CHUNK_SIZE = 1 << 16; // smaller chunks cost more in scheduling than they save
+static const int CHUNKS_PER_THREAD = 4; // a few chunks per thread even out the uneven ones
+
+struct ChunkResult { // What one chunk of the text turned into
+    vector<vector<ImportedLine>> buckets; // single events and days off, spread by day
+    vector<ImportedLine> seriesLines;
+    int lineCount = 0;
+    bool failed = false;
+    int errorCode = 0;
+    int errorLine = 0; // counted from the start of the chunk
+    int errorColumn = 0;
+};
+
+BulkImporter::BulkImporter(ThreadPool& pool) : pool(pool) {
+}
+
+vector<ImportConflict> BulkImporter::importDays(string_view text, DayStore& days, const RecurrenceStore& rules, vector<ImportedLine>& seriesLines, vector<int>& daysOff) {
+    // Cut the text into chunks that end at a line break
+    vector<string_view> chunks;
+    size_t chunkCount = max((size_t)1, min((size_t)(pool.size() * CHUNKS_PER_THREAD), text.size() / MINIMUM_CHUNK_SIZE));
+    size_t chunkStart = 0;
+    for (size_t i = 1; i <= chunkCount && chunkStart < text.size(); ++i) {
+        size_t chunkEnd = (i == chunkCount) ? text.size() : max(chunkStart, text.size() * i / chunkCount);
+        const char* lineBreak = static_cast<const char*>(memchr(text.data() + chunkEnd, '\n', text.size() - chunkEnd));
+        chunkEnd = (lineBreak == nullptr) ? text.size() : (size_t)(lineBreak - text.data()) + 1;
+        chunks.push_back(text.substr(chunkStart, chunkEnd - chunkStart));
+        chunkStart = chunkEnd;
+    }
+
+    // Parse the chunks in parallel, spreading the lines over the buckets by day
+    int bucketCount = pool.size() * CHUNKS_PER_THREAD;
+    vector<ChunkResult> results(chunks.size());
+    pool.parallelFor((int)chunks.size(), [&](int index) {
+        ChunkResult& result = results[index];
+        result.buckets.resize(bucketCount);
+        TextParser parser(chunks[index]);
+        ImportedLine line;
+        try {
+            while (parser.next(line.text)) {
+                line.line = parser.currentLine();
+                if (line.text.repeatType != RepeatType::None && !line.text.isDayOff) {
+                    result.seriesLines.push_back(line);
+                }
+                else {
+                    int bucket = line.text.date % bucketCount;
+                    result.buckets[bucket < 0 ? bucket + bucketCount : bucket].push_back(line);
+                }
+            }
+        }
+        catch (const ParseExceptions& exception) {
+            result.failed = true;
+            result.errorCode = exception.getCode();
+            result.errorLine = exception.getLine();
+            result.errorColumn = exception.getColumn();
+        }
+        result.lineCount = parser.currentLine();
+    });
+
+    // Turn the line numbers of the chunks into line numbers of the file, and stop at the first malformed line
+    int firstLine = 0;
+    for (ChunkResult& result : results) {
+        if (result.failed) {
+            throw ParseExceptions(result.errorCode, firstLine + result.errorLine, result.errorColumn);
+        }
+        for (vector<ImportedLine>& bucket : result.buckets) {
+            for (ImportedLine& line : bucket) {
+                line.line += firstLine;
+            }
+        }
+        for (ImportedLine& line : result.seriesLines) {
+            line.line += firstLine;
+            seriesLines.push_back(line);
+        }
+        firstLine += result.lineCount;
+    }
+
+    // Build the days of each bucket in parallel, the stored days are only read while this runs
+    vector<vector<Day>> builtDays(bucketCount);
+    vector<vector<ImportConflict>> bucketConflicts(bucketCount);
+    pool.parallelFor(bucketCount, [&](int bucket) {
+        vector<ImportedLine> lines;
+        for (ChunkResult& result : results) { // chunks are taken in file order, so equal lines keep their order
+            lines.insert(lines.end(), result.buckets[bucket].begin(), result.buckets[bucket].end());
+            vector<ImportedLine>().swap(result.buckets[bucket]);
+        }
+        buildDays(lines, days, rules, builtDays[bucket], bucketConflicts[bucket]);
+    });
+
+    vector<ImportConflict> conflicts;
+    for (int bucket = 0; bucket < bucketCount; ++bucket) {
+        for (Day& day : builtDays[bucket]) {
+            if (day.isDayOff) {
+                daysOff.push_back(day.date);
+            }
+            days.store(move(day));
+        }
+        conflicts.insert(conflicts.end(), bucketConflicts[bucket].begin(), bucketConflicts[bucket].end());
+    }
+    sort(conflicts.begin(), conflicts.end(), [](const ImportConflict& first, const ImportConflict& second) {
+        return first.line < second.line;
+    });
+    return conflicts;
+}
+
+void BulkImporter::buildDays(vector<ImportedLine>& lines, const DayStore& days, const RecurrenceStore& rules, vector<Day>& builtDays, vector<ImportConflict>& conflicts) const {
+    stable_sort(lines.begin(), lines.end(), [](const ImportedLine& first, const ImportedLine& second) { // days off come first so that they apply to the whole day
+        if (first.text.date != second.text.date) return first.text.date < second.text.date;
+        if (first.text.isDayOff != second.text.isDayOff) return first.text.isDayOff;
+        if (first.text.isDayOff) return false;
+        if (first.text.startTime != second.text.startTime) return first.text.startTime < second.text.startTime;
+        return first.text.endTime < second.text.endTime;
+    });
+
+    // The distinct titles of the bucket are interned together, so the threads do not take turns on the pool for every line
+    unordered_map<string_view, uint32_t> titleIndex;
+    vector<string_view> distinctTitles;
+    vector<uint32_t> titleOfLine(lines.size()); // index into distinctTitles
+    for (size_t i = 0; i < lines.size(); ++i) {
+        auto found = titleIndex.emplace(lines[i].text.title, (uint32_t)distinctTitles.size());
+        if (found.second) {
+            distinctTitles.push_back(lines[i].text.title);
+        }
+        titleOfLine[i] = found.first->second;
+    }
+    vector<Title> titles = Title::makeAll(distinctTitles);
+
+    size_t runStart = 0;
+    while (runStart < lines.size()) { // one run of lines per day
+        int date = lines[runStart].text.date;
+        size_t runEnd = runStart;
+        while (runEnd < lines.size() && lines[runEnd].text.date == date) {
+            ++runEnd;
+        }
+
+        const Day* storedDay = days.find(date);
+        Day day = (storedDay != nullptr) ? *storedDay : Day(date);
+        if (lines[runStart].text.isDayOff) {
+            day.isDayOff = true;
+            day.clearEvents();
+        }
+
+        const TextLine* lastAdded = nullptr; // the lines are sorted by start time, so only the last one added can overlap the next
+        for (size_t i = runStart; i < runEnd; ++i) {
+            const TextLine& text = lines[i].text;
+            if (text.isDayOff) {
+                continue;
+            }
+            Event event(titles[titleOfLine[i]], text.startTime, text.endTime, text.repeatType);
+
+            string reason;
+            if (day.isDayOff) {
+                reason = "the day is off";
+            }
+            else if (lastAdded != nullptr && text.startTime < lastAdded->endTime && text.endTime > lastAdded->startTime) {
+                reason = "overlaps " + string(lastAdded->title);
+            }
+            else {
+                vector<Conflict> existing = ConflictChecker::findConflicts(date, event, days, rules); // the stored events and the series
+                if (!existing.empty()) {
+                    reason = "overlaps " + existing.front().title;
+                }
+            }
+            if (!reason.empty()) {
+                conflicts.push_back({ lines[i].line, date, event.title.toString(), reason });
+                continue;
+            }
+
+            if (storedDay == nullptr || storedDay->events.empty()) {
+                day.appendEvent(event); // sorted input, so the event goes to the end
+            }
+            else {
+                day.addEvent(event); // merged between the events that were already stored
+            }
+            lastAdded = &text;
+        }
+        builtDays.push_back(move(day));
+        runStart = runEnd;
+    }
+}
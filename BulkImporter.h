@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DayStore.h"
+#include "RecurrenceStore.h"
+#include "TextParser.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+struct ImportedLine { // A parsed line together with its line number in the imported file
+    int line;
+    TextLine text;
+};
+
+struct ImportConflict { // A line of a bulk import that was left out
+    int line;
+    int date;
+    string title;
+    string reason;
+};
+
+/*
+ * Bulk import of the event text format for files with millions of lines.
+ *
+ * The text is cut into chunks at line breaks and the chunks are parsed on the thread pool. The parsed lines
+ * are spread over buckets by day, and each bucket sorts its lines once and builds every day of it in a
+ * single pass, leaving out (and reporting) the events that would overlap. Only the finished days are
+ * stored one after another at the end.
+ *
+ * Series lines are few, so they are handed back in file order for the scheduler to add after the days. The days
+ * that are off after the import are handed back as well, because the series are only read while the days are
+ * built: the scheduler cancels their occurrences on those days.
+ */
+class BulkImporter {
+private:
+    ThreadPool& pool;
+
+    void buildDays(vector<ImportedLine>& lines, const DayStore& days, const RecurrenceStore& rules, vector<Day>& builtDays, vector<ImportConflict>& conflicts) const;
+
+public:
+    BulkImporter(ThreadPool& pool);
+
+    // Throws ParseExceptions for the first malformed line of the file, before anything is stored
+    vector<ImportConflict> importDays(string_view text, DayStore& days, const RecurrenceStore& rules, vector<ImportedLine>& seriesLines, vector<int>& daysOff);
+};
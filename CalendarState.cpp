@@ -0,0 +1,48 @@
+#include "CalendarState.h"
+
+using namespace std;
+
+Day CalendarState::expandDay(int date) const {
+    const Day* storedDay = days.find(date);
+    Day day = (storedDay != nullptr) ? *storedDay : Day(date);
+
+    rules.forEachOccurringOn(date, [&day](const RecurrenceRule& rule) {
+        Event occurrence = rule.event;
+        day.addEvent(occurrence);
+    });
+    return day;
+}
+
+OccupancyBitmap CalendarState::busyMinutes(int date) const {
+    const Day* storedDay = days.find(date);
+    OccupancyBitmap busy = (storedDay != nullptr) ? storedDay->occupancy : OccupancyBitmap();
+    if (storedDay != nullptr && storedDay->isDayOff) {
+        busy.setRange(0, OccupancyBitmap::MINUTES_PER_DAY); // nobody is available on a day off
+        return busy;
+    }
+
+    rules.forEachOccurringOn(date, [&busy](const RecurrenceRule& rule) {
+        busy.setRange(rule.event.startTime.toMinutes(), rule.event.endTime.toMinutes());
+    });
+    return busy;
+}
+
+void CalendarState::record(Change* change) {
+    days.record(change != nullptr ? &change->days : nullptr);
+    rules.record(change != nullptr ? &change->rules : nullptr);
+}
+
+void CalendarState::revert(Change& change) {
+    days.revert(change.days);
+    rules.revert(change.rules);
+}
+
+void CalendarState::restore(const CalendarState& version, Change& change) {
+    days.restore(version.days, change.days);
+    rules.restore(version.rules, change.rules);
+}
+
+void CalendarState::markPublished() {
+    days.markPublished();
+    rules.markPublished();
+}
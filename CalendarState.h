@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Day.h"
+#include "DayStore.h"
+#include "RecurrenceStore.h"
+#include "OccupancyBitmap.h"
+
+using namespace std;
+
+struct CalendarState { // One version of the calendar. A copy shares every segment of days and the series until one side writes to them
+    DayStore days;
+    RecurrenceStore rules; // repeating events, kept once per series
+
+    struct Change { // what one change touched, as it was before, see DayStore::record()
+        DayStore::Change days;
+        RecurrenceStore::Change rules;
+    };
+
+    void record(Change* change); // nullptr stops the recording
+    void revert(Change& change); // undo the change, or redo it if it was reverted before
+    void restore(const CalendarState& version, Change& change); // go back to a copy, recording what it replaced so that it can be reverted as well
+    void markPublished(); // a copy was handed to readers, see DayStore::markPublished()
+
+    Day expandDay(int date) const; // the day as it is shown, with the occurrences of the series merged in
+    OccupancyBitmap busyMinutes(int date) const; // the minutes taken by the stored events and the series on the day, all of them on a day off
+};
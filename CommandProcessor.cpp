@@ -0,0 +1,247 @@
+#include "CommandProcessor.h"
+#include "Date.h"
+#include "TextParser.h"
+#include "ParseExceptions.h"
+#include "EventExceptions.h"
+#include "SchedulerExceptions.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <charconv>
+
+using namespace std;
+
+static const size_t OUTPUT_BLOCK_SIZE = 1 << 16; // answers are collected up to this size before they are written
+
+static string_view requireField(string_view& arguments, int lineNumber, string_view line) { // the next '|' field, or an error if there is none
+    if (arguments.data() == nullptr) {
+        throw ParseExceptions(3, lineNumber, (int)line.size() + 1);
+    }
+    return TextParser::nextField(arguments, '|');
+}
+
+static int column(string_view field, string_view line) {
+    return (int)(field.data() - line.data()) + 1;
+}
+
+CommandProcessor::CommandProcessor(Scheduler& scheduler) : scheduler(scheduler) {
+    this->lineNumber = 0;
+}
+
+void CommandProcessor::execute(string_view line, string& output) {
+    ++lineNumber;
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (line.empty() || line[0] == '#') {
+        return;
+    }
+
+    try {
+        executeCommand(line, output);
+    }
+    catch (const ParseExceptions& exception) {
+        output += "ERR ";
+        output += exception.what();
+        output += '\n';
+    }
+    catch (const exception& exception) {
+        output += "ERR Line " + to_string(lineNumber) + ": " + exception.what() + "\n";
+    }
+}
+
+void CommandProcessor::writeStatus(const Status& status, string& output) const { // rejected commands are common in scripts, so they are answered without throwing
+    if (status.isOk()) {
+        output += "OK\n";
+        return;
+    }
+    output += "ERR Line " + to_string(lineNumber) + ": " + status.message() + "\n";
+}
+
+void CommandProcessor::writeChange(const Status& status, string& output) {
+    if (status.isOk()) {
+        unsyncedChanges.emplace_back(output.size(), lineNumber);
+    }
+    writeStatus(status, output);
+}
+
+void CommandProcessor::confirmChanges() {
+    unsyncedChanges.clear();
+}
+
+Status CommandProcessor::syncChanges(string& output) {
+    Status status = scheduler.sync();
+    if (status.isOk()) {
+        confirmChanges();
+    }
+    else {
+        markChangesPending(status, output);
+    }
+    return status;
+}
+
+void CommandProcessor::markChangesPending(const Status& status, string& output) {
+    if (unsyncedChanges.empty()) {
+        return;
+    }
+    string rewritten; // the answers from the first unsynced change on
+    size_t copied = unsyncedChanges.front().first;
+    for (const pair<size_t, int>& change : unsyncedChanges) {
+        rewritten.append(output, copied, change.first - copied);
+        rewritten += "PENDING Line " + to_string(change.second) + ": " + status.message() + "\n"; // made, but not durable before a later sync
+        copied = change.first + 3; // past the "OK\n"
+    }
+    rewritten.append(output, copied, string::npos);
+    output.replace(unsyncedChanges.front().first, string::npos, rewritten);
+    unsyncedChanges.clear();
+}
+
+void CommandProcessor::executeCommand(string_view line, string& output) {
+    string_view arguments = line;
+    string_view command = TextParser::nextField(arguments, '|');
+
+    auto readDate = [&]() {
+        string_view field = requireField(arguments, lineNumber, line);
+        int date = 0;
+        if (!TextParser::parseDate(field, date)) {
+            throw ParseExceptions(1, lineNumber, column(field, line));
+        }
+        return date;
+    };
+    auto readTime = [&]() {
+        string_view field = requireField(arguments, lineNumber, line);
+        Time time;
+        if (!Time::tryParse(field, time)) {
+            throw ParseExceptions(2, lineNumber, column(field, line));
+        }
+        return time;
+    };
+    auto readTitle = [&]() {
+        string_view field = requireField(arguments, lineNumber, line);
+        if (field.empty()) {
+            throw ParseExceptions(4, lineNumber, column(field, line));
+        }
+        return string(field);
+    };
+
+    if (command == "schedule") {
+        int date = readDate();
+        string title = readTitle();
+        Time startTime = readTime();
+        Time endTime = readTime();
+        RepeatType repeatType = repeatTypeFromString(requireField(arguments, lineNumber, line));
+        bool overrideDayOff = (arguments.data() != nullptr && TextParser::nextField(arguments, '|') == "override");
+
+        Expected<Event> event = Event::make(title, startTime, endTime, repeatType);
+        if (!event.hasValue()) {
+            writeStatus(event.error(), output);
+            return;
+        }
+        Expected<vector<Conflict>> conflicts = scheduler.trySchedule(date, *event, overrideDayOff);
+        if (!conflicts.hasValue()) {
+            writeStatus(conflicts.error(), output);
+        }
+        else if (!conflicts->empty()) {
+            output += "ERR Line " + to_string(lineNumber) + ": " + EventExceptions::message(1) + " (" + conflicts->front().title + " on " + Date::fromDayNumber(conflicts->front().date).toString() + ")\n";
+        }
+        else {
+            writeChange(Status(), output);
+        }
+    }
+    else if (command == "cancel") {
+        int date = readDate();
+        string title = readTitle();
+        bool deleteRepeats = (arguments.data() != nullptr && TextParser::nextField(arguments, '|') == "all");
+        writeChange(scheduler.tryCancel(date, title, deleteRepeats), output);
+    }
+    else if (command == "shift") {
+        int date = readDate();
+        string title = readTitle();
+        int newDate = readDate();
+        writeChange(scheduler.tryShift(date, title, newDate), output);
+    }
+    else if (command == "dayoff") {
+        writeChange(scheduler.tryMarkDayOff(readDate()), output);
+    }
+    else if (command == "view") {
+        Day day = scheduler.daySchedule(readDate());
+        output += "OK " + to_string(day.events.size() + (day.isDayOff ? 1 : 0)) + "\n";
+        output += day.formatDayDataToString();
+    }
+    else if (command == "free") {
+        string_view field = requireField(arguments, lineNumber, line);
+        int duration = 0;
+        auto result = from_chars(field.data(), field.data() + field.size(), duration);
+        if (result.ec != errc() || result.ptr != field.data() + field.size() || duration <= 0) {
+            throw ParseExceptions(7, lineNumber, column(field, line));
+        }
+        int firstDay = readDate();
+        int lastDay = readDate();
+        Time windowStart = readTime();
+        Time windowEnd = readTime();
+
+        FreeSlot slot = scheduler.findFreeSlot(duration, firstDay, lastDay, windowStart, windowEnd);
+        if (slot.found) {
+            output += "OK " + Date::fromDayNumber(slot.date).toString() + "|" + slot.startTime.toString() + "|" + slot.endTime.toString() + "\n";
+        }
+        else {
+            output += "OK none\n";
+        }
+    }
+    else if (command == "stats") {
+        if (arguments.data() != nullptr) { // stats|file writes the histograms as JSON
+            if (!Stats::writeJson(string(TextParser::nextField(arguments, '|')))) {
+                throw SchedulerExceptions(4);
+            }
+            output += "OK\n";
+            return;
+        }
+        string lines = Stats::formatLines();
+        output += "OK " + to_string(count(lines.begin(), lines.end(), '\n')) + "\n";
+        output += lines;
+    }
+    else if (command == "undo") {
+        writeStatus(scheduler.tryUndo(), output);
+    }
+    else if (command == "redo") {
+        writeStatus(scheduler.tryRedo(), output);
+    }
+    else if (command == "version") {
+        writeStatus(scheduler.trySaveVersion(readTitle()), output);
+    }
+    else if (command == "restore") {
+        writeStatus(scheduler.tryRestoreVersion(readTitle()), output);
+    }
+    else if (command == "versions") {
+        vector<string> names = scheduler.savedVersionNames();
+        output += "OK " + to_string(names.size()) + "\n";
+        for (const string& name : names) {
+            output += name + "\n";
+        }
+    }
+    else if (command == "sync") {
+        writeStatus(syncChanges(output), output);
+    }
+    else {
+        throw ParseExceptions(6, lineNumber, 1);
+    }
+}
+
+void CommandProcessor::run(istream& input, ostream& output) {
+    string line;
+    string answers;
+    while (getline(input, line)) {
+        execute(line, answers);
+        if (answers.size() >= OUTPUT_BLOCK_SIZE) {
+            writeAnswers(answers, output);
+        }
+    }
+    writeAnswers(answers, output);
+    output.flush();
+}
+
+void CommandProcessor::writeAnswers(string& answers, ostream& output) { // a reader of the output never sees an OK that a crash could still take back
+    syncChanges(answers);
+    output.write(answers.data(), (streamsize)answers.size());
+    answers.clear();
+}
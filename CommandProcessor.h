@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Scheduler.h"
+
+using namespace std;
+
+/*
+ * Runs calendar commands given as text, one command per line, without prompts or redraws.
+ *
+ *   schedule|YYYY-MM-DD|title|HH:MM|HH:MM|none, daily or weekly[|override]    override gives up a day off
+ *   cancel|YYYY-MM-DD|title[|all]                                              all cancels the rest of a series
+ *   shift|YYYY-MM-DD|title|YYYY-MM-DD
+ *   dayoff|YYYY-MM-DD
+ *   view|YYYY-MM-DD
+ *   free|minutes|YYYY-MM-DD|YYYY-MM-DD|HH:MM|HH:MM
+ *   undo
+ *   redo
+ *   version|name                                                               keep the calendar as it is now under the name
+ *   restore|name                                                               go back to the version, undo takes it back again
+ *   versions
+ *   sync
+ *   stats[|file]                                                               file gets the histograms as JSON
+ *
+ * Each command answers with one line: "OK", or "ERR Line n: message". view answers "OK count" followed by
+ * the day in the text format, and free answers "OK YYYY-MM-DD|HH:MM|HH:MM" or "OK none". stats answers "OK count"
+ * followed by one name|count|failures|meanNs|p50Ns|p90Ns|p99Ns|maxNs line per operation, and versions answers "OK count"
+ * followed by the names of the saved versions.
+ * Empty lines and lines starting with '#' are skipped.
+ *
+ * The OK of a schedule, cancel, shift or dayoff only stands once the journal has been synced: until then the processor
+ * keeps where the answer is, so that markChangesPending() can turn it into "PENDING Line n: message" if the sync fails.
+ * A PENDING change is made and stays in the calendar, but it is not durable yet: its journal record is written with the
+ * next sync that succeeds (a sync command answered OK), and a crash before that loses it. run() syncs before it writes
+ * each block of answers for the same reason.
+ */
+class CommandProcessor {
+private:
+    Scheduler& scheduler;
+    int lineNumber;
+    vector<pair<size_t, int>> unsyncedChanges; // offset of the OK in the output and line number of each change that is not durable yet
+
+    void executeCommand(string_view line, string& output);
+    void writeStatus(const Status& status, string& output) const;
+    void writeChange(const Status& status, string& output); // writeStatus() for a journaled change
+    Status syncChanges(string& output); // sync the journal and confirm the changes, or mark them pending in the output
+    void writeAnswers(string& answers, ostream& output); // only once the changes they answer are durable
+
+public:
+    CommandProcessor(Scheduler& scheduler);
+
+    void execute(string_view line, string& output); // appends the answer to the command to the output
+    void confirmChanges(); // the journal was synced, the answers to the changes stand
+    void markChangesPending(const Status& status, string& output); // the journal could not be synced, the OKs of the changes since the last confirm become PENDING
+    void run(istream& input, ostream& output); // executes every line of the input, answers are written in large blocks after a journal sync
+};
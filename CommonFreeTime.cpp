@@ -0,0 +1,69 @@
+#include "CommonFreeTime.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+static const int DAYS_PER_TASK = 8; // the days of one batch are shared out this many at a time
+
+CommonFreeTime::CommonFreeTime(ThreadPool& pool) : pool(pool) {
+}
+
+void CommonFreeTime::addCalendar(const string& dataPath) {
+    calendars.push_back(make_unique<Scheduler>(INT_MIN, dataPath, true));
+}
+
+int CommonFreeTime::size() const {
+    return (int)calendars.size();
+}
+
+void CommonFreeTime::findOnDay(int date, int duration, int windowStart, int windowEnd, vector<CandidateSlot>& candidates) const {
+    OccupancyBitmap busy;
+    for (const unique_ptr<Scheduler>& calendar : calendars) {
+        busy.merge(calendar->busyMinutes(date));
+    }
+
+    int start = busy.findFreeRun(duration, windowStart, windowEnd);
+    while (start >= 0) {
+        int end = busy.nextBusy(start, windowEnd); // the whole common run is the gap
+        candidates.push_back({ date, Time::fromMinutes(start), Time::fromMinutes(start + duration), end - start });
+        start = busy.findFreeRun(duration, end, windowEnd);
+    }
+}
+
+vector<CandidateSlot> CommonFreeTime::findCommonSlots(int duration, int firstDay, int lastDay, Time windowStart, Time windowEnd, int maxResults) const {
+    vector<CandidateSlot> results;
+    if (duration <= 0 || maxResults <= 0) {
+        return results;
+    }
+
+    int batchDays = pool.size() * DAYS_PER_TASK * 4;
+    for (int batchStart = firstDay; batchStart <= lastDay && (int)results.size() < maxResults; batchStart += batchDays) {
+        int batchEnd = (int)min((long long)lastDay, (long long)batchStart + batchDays - 1);
+        int taskCount = (batchEnd - batchStart) / DAYS_PER_TASK + 1;
+        vector<vector<CandidateSlot>> found(taskCount);
+
+        pool.parallelFor(taskCount, [&](int task) { // the calendars are only read, so the days can be searched side by side
+            int taskStart = batchStart + task * DAYS_PER_TASK;
+            for (int date = taskStart; date <= batchEnd && date < taskStart + DAYS_PER_TASK; ++date) {
+                vector<CandidateSlot> dayCandidates;
+                findOnDay(date, duration, windowStart.toMinutes(), windowEnd.toMinutes(), dayCandidates);
+                stable_sort(dayCandidates.begin(), dayCandidates.end(), [](const CandidateSlot& first, const CandidateSlot& second) {
+                    return first.gap > second.gap;
+                });
+                found[task].insert(found[task].end(), dayCandidates.begin(), dayCandidates.end());
+            }
+        });
+
+        for (const vector<CandidateSlot>& taskCandidates : found) { // the tasks are in date order
+            for (const CandidateSlot& candidate : taskCandidates) {
+                if ((int)results.size() == maxResults) {
+                    return results;
+                }
+                results.push_back(candidate);
+            }
+        }
+    }
+    return results;
+}
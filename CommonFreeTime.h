@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Scheduler.h"
+#include "ThreadPool.h"
+#include "Time.h"
+
+using namespace std;
+
+struct CandidateSlot { // A time that every calendar has free
+    int date;
+    Time startTime;
+    Time endTime;
+    int gap; // minutes of the common free time around the slot, a larger gap leaves more room to move the meeting
+};
+
+/*
+ * Finds meeting times that suit several calendars at once, such as one calendar per person or room.
+ *
+ * For every day the busy bitmaps of the calendars are ORed together, so a minute is left clear only if every
+ * calendar has it free. Each common free run that is long enough gives one candidate, at the start of the run.
+ * The candidates are ranked by date, then by the size of the common gap, then by start time.
+ * The days are shared out over the thread pool in batches, and the search stops at the first batch that fills the results.
+ */
+class CommonFreeTime {
+private:
+    vector<unique_ptr<Scheduler>> calendars;
+    ThreadPool& pool;
+
+    void findOnDay(int date, int duration, int windowStart, int windowEnd, vector<CandidateSlot>& candidates) const;
+
+public:
+    CommonFreeTime(ThreadPool& pool);
+
+    void addCalendar(const string& dataPath); // loaded read-only, see Scheduler::Scheduler()
+    int size() const;
+
+    vector<CandidateSlot> findCommonSlots(int duration, int firstDay, int lastDay, Time windowStart, Time windowEnd, int maxResults) const;
+};
@@ -0,0 +1,95 @@
+#include "ConflictChecker.h"
+
+#include <algorithm>
+
+using namespace std;
+
+static long long extendedGcd(long long a, long long b, long long& x, long long& y) { // a * x + b * y = gcd(a, b)
+    if (b == 0) {
+        x = 1;
+        y = 0;
+        return a;
+    }
+    long long x1, y1;
+    long long g = extendedGcd(b, a % b, x1, y1);
+    x = y1;
+    y = x1 - (a / b) * y1;
+    return g;
+}
+
+static long long floorMod(long long value, long long modulus) {
+    long long result = value % modulus;
+    return result < 0 ? result + modulus : result;
+}
+
+int ConflictChecker::firstCommonOccurrence(const RecurrenceRule& first, const RecurrenceRule& second, int fromDay) {
+    // The days of the series are firstDay + k * period. Two series share the days x with
+    // x = first.firstDay (mod first.period) and x = second.firstDay (mod second.period), which have a solution only
+    // if the gcd of the periods divides the distance between the first days. The shared days then repeat every lcm.
+    long long s, t;
+    long long g = extendedGcd(first.period, second.period, s, t);
+    long long distance = (long long)second.firstDay - first.firstDay;
+    if (distance % g != 0) {
+        return RecurrenceRule::NO_END;
+    }
+
+    long long lcm = first.period / g * second.period;
+    long long step = floorMod(distance / g % (second.period / g) * s, second.period / g);
+    long long common = floorMod(first.firstDay + first.period * step, lcm); // a shared day, reduced into [0, lcm)
+
+    long long start = max({ (long long)fromDay, (long long)first.firstDay, (long long)second.firstDay });
+    long long end = min(first.lastDay, second.lastDay);
+    long long date = start + floorMod(common - start, lcm);
+
+    // Each cancelled occurrence hides at most one shared day, so the loop ends after that many steps at most
+    for (; date <= end; date += lcm) {
+        if (first.occursOn((int)date) && second.occursOn((int)date)) {
+            return (int)date;
+        }
+    }
+    return RecurrenceRule::NO_END;
+}
+
+vector<Conflict> ConflictChecker::findConflicts(const RecurrenceRule& rule, const DayStore& days, const RecurrenceStore& rules) { // Every conflict of a new series
+    vector<Conflict> conflicts;
+
+    days.forEachInRange(rule.firstDay, rule.lastDay, [&rule, &conflicts](const Day& day) { // Only stored days can hold single events
+        if (day.isDayOff || !rule.occursOn(day.date)) {
+            return;
+        }
+        for (const Event* conflict : day.findConflicts(rule.event)) {
+            conflicts.push_back({ day.date, conflict->title.toString() });
+        }
+    });
+
+    rules.forEach([&rule, &conflicts](const RecurrenceRule& existingRule) {
+        if (!rule.event.overlaps(existingRule.event)) {
+            return;
+        }
+        int date = firstCommonOccurrence(rule, existingRule, rule.firstDay);
+        if (date != RecurrenceRule::NO_END) {
+            conflicts.push_back({ date, existingRule.event.title.toString() });
+        }
+    });
+
+    stable_sort(conflicts.begin(), conflicts.end(), [](const Conflict& first, const Conflict& second) { return first.date < second.date; });
+    return conflicts;
+}
+
+vector<Conflict> ConflictChecker::findConflicts(int date, const Event& event, const DayStore& days, const RecurrenceStore& rules) { // Every conflict of a new single event
+    vector<Conflict> conflicts;
+
+    const Day* day = days.find(date);
+    if (day != nullptr) {
+        for (const Event* conflict : day->findConflicts(event)) {
+            conflicts.push_back({ date, conflict->title.toString() });
+        }
+    }
+
+    rules.forEachOccurringOn(date, [date, &event, &conflicts](const RecurrenceRule& rule) {
+        if (event.overlaps(rule.event)) {
+            conflicts.push_back({ date, rule.event.title.toString() });
+        }
+    });
+    return conflicts;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Event.h"
+#include "DayStore.h"
+#include "RecurrenceRule.h"
+#include "RecurrenceStore.h"
+
+using namespace std;
+
+struct Conflict { // An existing event that a new event or series would overlap
+    int date; // first day on which the two overlap
+    string title;
+};
+
+class ConflictChecker { // Decides overlaps between series and single events arithmetically, without expanding occurrences
+public:
+    // First day on or after fromDay where both series occur (cancelled occurrences excluded), or RecurrenceRule::NO_END
+    static int firstCommonOccurrence(const RecurrenceRule& first, const RecurrenceRule& second, int fromDay);
+
+    static vector<Conflict> findConflicts(const RecurrenceRule& rule, const DayStore& days, const RecurrenceStore& rules);
+
+    static vector<Conflict> findConflicts(int date, const Event& event, const DayStore& days, const RecurrenceStore& rules);
+};
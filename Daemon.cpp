@@ -0,0 +1,299 @@
+#include "Daemon.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+Daemon::Daemon(Scheduler& scheduler, const string& socketPath) : scheduler(scheduler) {
+    this->socketPath = socketPath;
+    this->listenSocket = -1;
+    this->epollHandle = -1;
+    this->signalHandle = -1;
+}
+
+Daemon::~Daemon() {
+    shutdown();
+}
+
+#ifdef __linux__
+
+static bool watch(int epollHandle, int handle, uint32_t events, int operation = EPOLL_CTL_ADD) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = handle;
+    return epoll_ctl(epollHandle, operation, handle, &event) == 0;
+}
+
+bool Daemon::openSocket() {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    struct stat status;
+    if (lstat(socketPath.c_str(), &status) == 0) { // a socket left behind by a daemon that did not shut down is replaced, a running daemon is not
+        if (!S_ISSOCK(status.st_mode)) {
+            return false;
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool inUse = (probe >= 0 && connect(probe, (const sockaddr*)&address, sizeof(address)) == 0);
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (inUse) {
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    int handle = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (handle < 0) {
+        return false;
+    }
+    if (bind(handle, (const sockaddr*)&address, sizeof(address)) != 0) {
+        ::close(handle);
+        return false;
+    }
+    listenSocket = handle; // from here on shutdown() removes the socket file again
+    if (chmod(socketPath.c_str(), 0600) != 0 || listen(listenSocket, SOMAXCONN) != 0) {
+        return false;
+    }
+
+    sigset_t signals; // SIGINT and SIGTERM arrive through the event loop, so a command is never cut off halfway
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    if (sigprocmask(SIG_BLOCK, &signals, nullptr) != 0) {
+        return false;
+    }
+    signalHandle = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    epollHandle = epoll_create1(EPOLL_CLOEXEC);
+    return signalHandle >= 0 && epollHandle >= 0 && watch(epollHandle, listenSocket, EPOLLIN) && watch(epollHandle, signalHandle, EPOLLIN);
+}
+
+void Daemon::acceptClients() {
+    while (true) {
+        int client = accept4(listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client < 0) {
+            return; // EAGAIN once every waiting client is taken, other errors are left to the client
+        }
+        if (!watch(epollHandle, client, EPOLLIN)) {
+            ::close(client);
+            continue;
+        }
+        connections.emplace(piecewise_construct, forward_as_tuple(client), forward_as_tuple(scheduler));
+    }
+}
+
+bool Daemon::readClient(int socket, Connection& connection) {
+    char buffer[1 << 16];
+    while (!connection.closing && connection.output.size() - connection.outputSent < MAX_PENDING_OUTPUT) {
+        ssize_t received = recv(socket, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            connection.input.append(buffer, (size_t)received);
+            if (connection.input.size() > MAX_LINE_LENGTH && connection.input.find('\n', connection.input.size() - (size_t)received) == string::npos) {
+                break; // runCommands() answers the overlong line and closes the connection
+            }
+        }
+        else if (received == 0) {
+            connection.closing = true; // the client sent its last command, the answers still go out
+        }
+        else if (errno == EINTR) {
+            continue;
+        }
+        else {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+    return true;
+}
+
+bool Daemon::runCommands(Connection& connection) {
+    bool ran = false;
+    size_t lineStart = 0;
+    while (connection.output.size() - connection.outputSent < MAX_PENDING_OUTPUT) {
+        size_t lineEnd = connection.input.find('\n', lineStart);
+        if (lineEnd == string::npos) {
+            break;
+        }
+        connection.processor.execute(string_view(connection.input).substr(lineStart, lineEnd - lineStart), connection.output);
+        lineStart = lineEnd + 1;
+        ran = true;
+    }
+    connection.input.erase(0, lineStart);
+
+    if (connection.input.size() > MAX_LINE_LENGTH && connection.input.find('\n') == string::npos) {
+        connection.output += "ERR The command is too long\n";
+        connection.input.clear();
+        connection.closing = true;
+    }
+    else if (connection.closing && !connection.input.empty() && connection.input.find('\n') == string::npos) { // the last line had no line break
+        connection.processor.execute(connection.input, connection.output);
+        connection.input.clear();
+        ran = true;
+    }
+    return ran;
+}
+
+bool Daemon::sendAnswers(int socket, Connection& connection) {
+    while (connection.outputSent < connection.output.size()) {
+        ssize_t sent = send(socket, connection.output.data() + connection.outputSent, connection.output.size() - connection.outputSent, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection.outputSent += (size_t)sent;
+        }
+        else if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        else {
+            return false;
+        }
+    }
+    if (connection.outputSent == connection.output.size()) {
+        connection.output.clear();
+        connection.outputSent = 0;
+    }
+
+    bool hasAnswers = !connection.output.empty();
+    bool hasCommands = connection.input.find('\n') != string::npos; // held back while the answers were piling up
+    if (connection.closing && !hasAnswers && !hasCommands) {
+        return false;
+    }
+    bool roomForAnswers = connection.output.size() - connection.outputSent < MAX_PENDING_OUTPUT;
+    uint32_t events = 0;
+    if (!connection.closing && roomForAnswers) {
+        events |= EPOLLIN;
+    }
+    if (hasAnswers || (hasCommands && roomForAnswers)) {
+        events |= EPOLLOUT; // a writable socket also brings the held back commands to the next round
+    }
+    return watch(epollHandle, socket, events, EPOLL_CTL_MOD);
+}
+
+void Daemon::closeClient(int socket) {
+    epoll_ctl(epollHandle, EPOLL_CTL_DEL, socket, nullptr);
+    ::close(socket);
+    connections.erase(socket);
+}
+
+bool Daemon::run() {
+    if (!openSocket()) {
+        shutdown();
+        return false;
+    }
+
+    epoll_event events[64];
+    vector<int> active; // clients that had something happen in this round
+    bool stopping = false;
+    while (!stopping) {
+        int count = epoll_wait(epollHandle, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        bool ran = false;
+        active.clear();
+        for (int i = 0; i < count; ++i) {
+            int handle = events[i].data.fd;
+            if (handle == listenSocket) {
+                acceptClients();
+                continue;
+            }
+            if (handle == signalHandle) {
+                stopping = true;
+                continue;
+            }
+            auto it = connections.find(handle);
+            if (it == connections.end()) {
+                continue;
+            }
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !readClient(handle, it->second)) {
+                closeClient(handle);
+                continue;
+            }
+            ran = runCommands(it->second) || ran;
+            active.push_back(handle);
+        }
+
+        if (ran) {
+            Status status = scheduler.sync(); // one journal write for the changes of every client in the round, before any of them is answered
+            for (int handle : active) {
+                auto it = connections.find(handle);
+                if (it == connections.end()) {
+                    continue;
+                }
+                if (status.isOk()) {
+                    it->second.processor.confirmChanges();
+                }
+                else {
+                    it->second.processor.markChangesPending(status, it->second.output); // the changes are made but not durable, so they are not answered OK
+                }
+            }
+        }
+        for (int handle : active) {
+            auto it = connections.find(handle);
+            if (it != connections.end() && !sendAnswers(handle, it->second)) {
+                closeClient(handle);
+            }
+        }
+    }
+    shutdown();
+    return true;
+}
+
+void Daemon::shutdown() {
+    while (!connections.empty()) {
+        closeClient(connections.begin()->first);
+    }
+    if (listenSocket >= 0) {
+        ::close(listenSocket);
+        unlink(socketPath.c_str());
+        listenSocket = -1;
+    }
+    if (signalHandle >= 0) {
+        ::close(signalHandle);
+        signalHandle = -1;
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        sigprocmask(SIG_UNBLOCK, &signals, nullptr);
+    }
+    if (epollHandle >= 0) {
+        ::close(epollHandle);
+        epollHandle = -1;
+    }
+}
+
+#else
+
+bool Daemon::run() { // needs epoll and Unix domain sockets
+    return false;
+}
+
+void Daemon::shutdown() {
+}
+
+#endif
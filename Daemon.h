@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "Scheduler.h"
+#include "CommandProcessor.h"
+
+using namespace std;
+
+/*
+ * Keeps one calendar in memory and serves the commands of CommandProcessor to local clients over a Unix domain
+ * socket, so that clients do not load and rewrite the calendar files themselves.
+ *
+ * Every line a client sends is one command and gets one answer line, in order. A client may send many commands
+ * without waiting for the answers. One epoll loop serves every client: each round runs the complete lines that
+ * arrived, makes the changes of the round durable with one journal sync and only then sends the answers, so an
+ * "OK" is never lost by a crash. If the sync fails, the changes of the round are answered with PENDING instead: they
+ * stay made, and their journal records are written with the next sync that succeeds, such as a sync command answered OK.
+ *
+ * Linux only, run() fails on other systems.
+ */
+class Daemon {
+private:
+    struct Connection {
+        CommandProcessor processor; // counts the lines of this client, so "ERR Line n" names the client's own command
+        string input; // bytes received after the last complete line
+        string output; // answers that are not sent yet
+        size_t outputSent;
+        bool closing; // close once the answers are sent
+
+        Connection(Scheduler& scheduler) : processor(scheduler), outputSent(0), closing(false) {}
+    };
+
+    static const size_t MAX_LINE_LENGTH = 1 << 16;
+    static const size_t MAX_PENDING_OUTPUT = 1 << 20; // stop reading commands from a client that does not read its answers
+
+    Scheduler& scheduler;
+    string socketPath;
+    int listenSocket;
+    int epollHandle;
+    int signalHandle;
+    unordered_map<int, Connection> connections;
+
+    bool openSocket();
+    void acceptClients();
+    bool readClient(int socket, Connection& connection); // false once the client has gone
+    bool runCommands(Connection& connection); // true if a command was run
+    bool sendAnswers(int socket, Connection& connection); // false if the connection has to be closed
+    void closeClient(int socket);
+    void shutdown();
+
+public:
+    Daemon(Scheduler& scheduler, const string& socketPath);
+    ~Daemon();
+    Daemon(const Daemon&) = delete;
+    Daemon& operator=(const Daemon&) = delete;
+
+    bool run(); // serves until SIGINT or SIGTERM, false if the socket could not be opened
+};
@@ -0,0 +1,106 @@
+#include "Date.h"
+#include "DateExceptions.h"
+
+#include <charconv>
+
+using namespace std;
+
+Date::Date(int year, int month, int day) {
+    this->year = year;
+    this->month = month;
+    this->day = day;
+
+    if (year < MIN_YEAR || year > MAX_YEAR || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) {
+        throw DateExceptions(1);
+    }
+}
+
+int Date::toDayNumber() const { // convert the date to the number of days since 1970-01-01
+    int y = (month <= 2) ? year - 1 : year; // the year is counted from March so that the leap day is the last day of the year
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+Date Date::fromDayNumber(int dayNumber) { // convert the number of days since 1970-01-01 to a date
+    dayNumber += 719468;
+    int era = (dayNumber >= 0 ? dayNumber : dayNumber - 146096) / 146097;
+    int dayOfEra = dayNumber - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int shiftedMonth = (5 * dayOfYear + 2) / 153;
+    int day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    int month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    int year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+    return Date(year, month, day);
+}
+
+int Date::dayOfWeek(int dayNumber) { // 1970-01-01 was a Thursday
+    int weekday = (dayNumber + 4) % 7;
+    return weekday < 0 ? weekday + 7 : weekday;
+}
+
+int Date::daysInMonth(int year, int month) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month == 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) {
+        return 29;
+    }
+    return days[month - 1];
+}
+
+string Date::monthName(int month) {
+    static const string months[] = { "January", "February", "March", "April", "May", "June", "July", "August", "September", "October", "November", "December" };
+    return months[month - 1];
+}
+
+string Date::dayName(int dayOfWeek) {
+    static const string days[] = { "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
+    return days[dayOfWeek];
+}
+
+string Date::toString() const { // return the date as YYYY-MM-DD
+    char buffer[MAX_TEXT_LENGTH];
+    return string(buffer, writeTo(buffer));
+}
+
+int Date::writeTo(char* buffer) const {
+    char* end = to_chars(buffer, buffer + MAX_TEXT_LENGTH - 6, year).ptr;
+    end[0] = '-';
+    end[1] = (char)('0' + month / 10);
+    end[2] = (char)('0' + month % 10);
+    end[3] = '-';
+    end[4] = (char)('0' + day / 10);
+    end[5] = (char)('0' + day % 10);
+    return (int)(end + 6 - buffer);
+}
+
+string Date::toLongString() const { // return the date as it is shown in the schedules
+    return to_string(day) + " " + monthName(month) + " " + to_string(year);
+}
+
+void Date::fromString(string_view dateString) {
+    if (!tryParse(dateString, *this)) {
+        throw DateExceptions(1);
+    }
+}
+
+bool Date::tryParse(string_view dateString, Date& date) { // parse in place, the text format reads every date through here
+    const char* position = dateString.data();
+    const char* end = position + dateString.size();
+    int year = 0, month = 0, day = 0;
+
+    auto result = from_chars(position, end, year);
+    if (result.ec != errc() || result.ptr == end || *result.ptr != '-') return false;
+    result = from_chars(result.ptr + 1, end, month);
+    if (result.ec != errc() || result.ptr == end || *result.ptr != '-') return false;
+    result = from_chars(result.ptr + 1, end, day);
+    if (result.ec != errc() || result.ptr != end) return false;
+
+    if (year < MIN_YEAR || year > MAX_YEAR || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) {
+        return false;
+    }
+    date = Date(year, month, day);
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "DateExceptions.h"
+
+using namespace std;
+
+class Date { // Class for the calendar dates
+public:
+    int year;
+    int month;
+    int day;
+
+    static const int MIN_YEAR = 1; // the years a date can have, so that every date has four digits and its day number fits in an int
+    static const int MAX_YEAR = 9999;
+
+    Date(int year = 2024, int month = 7, int day = 1);
+
+    int toDayNumber() const; // days since 1970-01-01, used as the key of every stored day
+
+    static Date fromDayNumber(int dayNumber);
+
+    static int dayOfWeek(int dayNumber); // 0 = Sunday, 1 = Monday, ..., 6 = Saturday
+
+    static int daysInMonth(int year, int month);
+
+    static string monthName(int month);
+
+    static string dayName(int dayOfWeek);
+
+    string toString() const; // YYYY-MM-DD
+
+    static const int MAX_TEXT_LENGTH = 10; // of YYYY-MM-DD
+
+    int writeTo(char* buffer) const; // writes YYYY-MM-DD without a terminating null and returns its length
+
+    string toLongString() const; // 3 July 2024
+
+    void fromString(string_view dateString);
+
+    static bool tryParse(string_view dateString, Date& date); // YYYY-MM-DD with a year from MIN_YEAR to MAX_YEAR, returns false instead of throwing
+    /*
+     * Day number conversions referred from: chrono-Compatible Low-Level Date Algorithms https://howardhinnant.github.io/date_algorithms.html
+     * Author: Howard Hinnant
+     */
+};
@@ -0,0 +1,14 @@
+#include "DateExceptions.h"
+
+DateExceptions::DateExceptions(int code) : Exceptions(code) { // Constructor for the DateExceptions class
+    errorMessage = message(code);
+}
+
+const char* DateExceptions::message(int code) {
+    switch (code) {
+    case 1:
+        return "Invalid date. Please use the YYYY-MM-DD format";
+    default:
+        return "Date error";
+    }
+}
\ No newline at end of file
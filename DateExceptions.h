@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Exceptions.h"
+
+class DateExceptions : public Exceptions { // Derived class for the DateExceptions
+public:
+	DateExceptions(int code);
+	static const char* message(int code);
+};
\ No newline at end of file
@@ -1,113 +1,157 @@
 #include "Day.h"
 
 #include <string>
-#include <sstream>
+#include <algorithm>
 
+#include "Date.h"
 #include "Event.h"
 #include "EventExceptions.h"
 #include "DayExceptions.h"
 
 using namespace std;
 
-void Day::sortEvents() { // Bubble sort of the events in the day according to the start time
-    for (int i = 0; i < eventCount - 1; ++i) {
-        for (int j = 0; j < eventCount - i - 1; ++j) {
-            if (events[j].startTime.isLargerComparedTo(events[j + 1].startTime)) {
-                Event temp = events[j];
-                events[j] = events[j + 1];
-                events[j + 1] = temp;
-            }
-        }
-    }
+bool Day::isEarlier(const Event& first, const Event& second) { // Events are ordered by start time and then by end time
+    if (first.startTime != second.startTime) return first.startTime < second.startTime;
+    return first.endTime < second.endTime;
+}
+
+int Day::findInsertPosition(const Event& event) const { // Binary search for the first event that is ordered after the given event
+    return (int)(upper_bound(events.begin(), events.end(), event, isEarlier) - events.begin());
+}
+
+const Event* Day::overlappingNeighbour(const Event& event, int position) const {
+    // The stored events never overlap and are sorted, so every earlier event ends before the previous one starts
+    // and every later event starts after the next one ends. Only the two neighbours of the position can overlap.
+    if (position > 0 && event.overlaps(events[position - 1])) return &events[position - 1];
+    if (position < events.size() && event.overlaps(events[position])) return &events[position];
+    return nullptr;
 }
 
 
-Day::Day(int date, string dayOfWeek) {
+Day::Day(int date) {
     this->date = date;
     this->isDayOff = false;
-    this->dayOfWeek = dayOfWeek;
-    this->eventCount = 0;
+    this->version = 0;
 }
 
-void Day::addEvent(Event& event) { // Add an event to the day
+Status Day::tryAddEvent(const Event& event) {
     if (isDayOff) {
-        throw DayExceptions(1);
+        return Status(ErrorKind::Day, 1);
+    }
+    int position = findInsertPosition(event);
+    if (overlappingNeighbour(event, position) != nullptr) {
+        return Status(ErrorKind::Event, 1);
     }
-    for (int i = 0; i < eventCount; ++i) {
+    events.insert(events.begin() + position, event); // Insert at the position that keeps the events sorted
+    occupancy.setRange(event.startTime.toMinutes(), event.endTime.toMinutes());
+    return Status();
+}
+
+void Day::addEvent(Event& event) { // Add an event to the day
+    tryAddEvent(event).throwIfError();
+}
+
+void Day::appendEvent(const Event& event) {
+    events.push_back(event);
+    occupancy.setRange(event.startTime.toMinutes(), event.endTime.toMinutes());
+}
+
+bool Day::conflictsWith(const Event& event) const { // Check if the event overlaps with any event of the day
+    return findConflict(event) != nullptr;
+}
+
+const Event* Day::findConflict(const Event& event) const {
+    return overlappingNeighbour(event, findInsertPosition(event));
+}
+
+vector<const Event*> Day::findConflicts(const Event& event) const { // The overlapping events sit next to each other around the insert position
+    vector<const Event*> conflicts;
+    int position = findInsertPosition(event);
+    int first = (position > 0 && event.overlaps(events[position - 1])) ? position - 1 : position;
+
+    for (int i = first; i < events.size() && events[i].startTime < event.endTime; ++i) {
         if (event.overlaps(events[i])) {
-            throw EventExceptions(1);
+            conflicts.push_back(&events[i]);
         }
     }
-    if (eventCount >= 10) {
-        throw EventExceptions(2);
-    }
-    events[eventCount++] = event;
-    sortEvents();
+    return conflicts;
 }
 
 
-void Day::deleteEvent(string& title) { // Delete an event from the day
-    bool eventFound = false;
-    for (int i = 0; i < eventCount; ++i) {
+const Event* Day::findEvent(Title title) const {
+    for (int i = 0; i < events.size(); ++i) {
         if (events[i].title == title) {
-            eventFound = true;
-            for (int j = i; j < eventCount - 1; ++j) {
-                events[j] = events[j + 1];
-            }
-            --eventCount;
-            break;
+            return &events[i];
         }
     }
-    if (!eventFound) {
-        throw EventExceptions(3);
-    }
+    return nullptr;
 }
 
-void Day::shiftEvent(string& title, int newDate, Day* days) { // Shift an event to another day
-    bool eventFound = false;
-
-    for (int i = 0; i < eventCount; ++i) {
+Status Day::tryDeleteEvent(Title title) {
+    for (int i = 0; i < events.size(); ++i) {
         if (events[i].title == title) {
-            Event eventToShift = events[i];
-            
-            for (int j = 0; j < days[newDate - 1].eventCount; ++j) {
-                if (eventToShift.overlaps(days[newDate - 1].events[j])) { // Check if the event overlaps with any other events on the new date
-                    throw EventExceptions(7);
-                }
-            }
-           
-            deleteEvent(title);  // Remove the event from the current date
-            
-            days[newDate - 1].addEvent(eventToShift);// Add the event to the new date
-            eventFound = true;
-            break;
+            occupancy.clearRange(events[i].startTime.toMinutes(), events[i].endTime.toMinutes()); // the events never overlap, so no other event owns these minutes
+            events.erase(events.begin() + i); // Close the gap in one block move
+            return Status();
         }
     }
-    if (!eventFound) {
-        throw EventExceptions(3);
+    return Status(ErrorKind::Event, 3);
+}
+
+void Day::deleteEvent(Title title) { // Delete an event from the day
+    tryDeleteEvent(title).throwIfError();
+}
+
+Status Day::tryShiftEvent(Title title, Day& newDay) {
+    const Event* storedEvent = findEvent(title);
+    if (storedEvent == nullptr) {
+        return Status(ErrorKind::Event, 3);
     }
+    Event eventToShift = *storedEvent;
+    if (newDay.conflictsWith(eventToShift)) { // Check if the event overlaps with any other events on the new date
+        return Status(ErrorKind::Event, 7);
+    }
+    Status status = newDay.tryAddEvent(eventToShift); // Add the event to the new date first, so a day off there leaves this day as it was
+    if (status.isOk()) {
+        tryDeleteEvent(title); // Remove the event from the current date
+    }
+    return status;
+}
+
+void Day::shiftEvent(Title title, Day& newDay) { // Shift an event to another day
+    tryShiftEvent(title, newDay).throwIfError();
 }
+
 void Day::clearEvents() { // Clear all events from the day
-    eventCount = 0;
+    events.clear();
+    occupancy.clear();
 }
 
 string Day::toString() const { // Convert the day data to a string
-    if (eventCount == 0 && !isDayOff) return "";
+    string dayString;
+    appendText(dayString);
+    return dayString;
+}
+
+void Day::appendText(string& output) const {
+    if (events.empty() && !isDayOff) return;
 
-    stringstream EventStream;
-    EventStream << "\n      " << date << " July 2024 (" << dayOfWeek << ")";
+    output += "\n      ";
+    output += Date::fromDayNumber(date).toLongString();
+    output += " (";
+    output += Date::dayName(Date::dayOfWeek(date));
+    output += ')';
 
     if (isDayOff) {
-        EventStream << " (Day Off)";
+        output += " (Day Off)";
     }
-    EventStream << "\n";
+    output += '\n';
 
-    for (int i = 0; i < eventCount; ++i) {
-        EventStream << "  " << events[i].toString() << "\n";
+    for (int i = 0; i < events.size(); ++i) {
+        output += "  ";
+        events[i].appendText(output);
+        output += '\n';
     }
-
-    return EventStream.str(); // pass stringstream as string from the function
-
 }
 
 bool Day::toString_print() const { 
@@ -117,38 +161,21 @@ bool Day::toString_print() const {
 
 string Day::formatDayDataToString() const { 
     string dayString;
-    if (isDayOff) {
-        dayString = dayString + to_string(date) + "|off|\n"; // If the day is off, only the date and "off" are stored
-    }
-    for (int i = 0; i < eventCount; ++i) { // If the day is not off, the date and all the events are stored
-        dayString = dayString + to_string(date) + "|" + events[i].formatEventDataToString() + "\n";
-    }
+    appendDayData(dayString);
     return dayString; 
 }
 
-void Day::extractDayData(string& dayStr) {
-    stringstream dayStream(dayStr);
-    string line;
-    while (getline(dayStream, line)) {  // Extract the day data from the string
-        if (line.empty()) { // If the line is empty, continue to the next line
-            continue;
-        }
-        stringstream lineStream(line); 
-        string data;
-
-        getline(lineStream, data, '|'); // Extract the date 
-        date = stoi(data);
-
-        getline(lineStream, data, '|'); // Extract the day off status
-        if (data == "off") { // If the day is off, set the day off status to true
-            isDayOff = true;
-            clearEvents();
-        }
-        else { // If the day is not off, extract the event data
-            Event event;
-            event.extractEventData(line.substr(line.find('|') + 1));
-            isDayOff = false;
-            addEvent(event);
-        }
+void Day::appendDayData(string& output) const {
+    char dateString[Date::MAX_TEXT_LENGTH];
+    int dateLength = Date::fromDayNumber(date).writeTo(dateString); // formatted once for all the lines of the day
+    if (isDayOff) {
+        output.append(dateString, dateLength);
+        output += "|off|\n"; // If the day is off, only the date and "off" are stored
+    }
+    for (int i = 0; i < events.size(); ++i) { // If the day is not off, the date and all the events are stored
+        output.append(dateString, dateLength);
+        output += '|';
+        events[i].appendEventData(output);
+        output += '\n';
     }
 }
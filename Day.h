@@ -1,30 +1,48 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include "Event.h"
 #include "EventExceptions.h"
+#include "Status.h"
+#include "SmallVector.h"
+#include "OccupancyBitmap.h"
 
 using namespace std;
 
 class Day { // Class for the Days
 private:
-    void sortEvents(); // function to sort the events
+    static bool isEarlier(const Event& first, const Event& second); // ordering of the events: by start time, then by end time
+    int findInsertPosition(const Event& event) const; // binary search for the position that keeps the events sorted
+    const Event* overlappingNeighbour(const Event& event, int position) const;
 
 public:
-    int date;
+    int date; // absolute day number, see Date::toDayNumber()
     bool isDayOff;
-    Event events[10]; // maximum of 10 events per day
-    int eventCount;
-    string dayOfWeek;
+    SmallVector<Event, 4> events; // kept sorted so that no two events overlap, busy days spill over to the heap
+    OccupancyBitmap occupancy; // minutes covered by the events, change the events only through the member functions to keep it in step
+    uint64_t version; // stamped by DayStore on every write access, 0 for a day that was never stored
 
-    Day(int date = 0, string dayOfWeek = ""); 
+    Day(int date = 0); 
+
+    // The try functions report a day off, an overlap or a missing event as a Status, the others throw it
+    Status tryAddEvent(const Event& event);
+    Status tryDeleteEvent(Title title);
+    Status tryShiftEvent(Title title, Day& newDay);
 
     void addEvent(Event& event);
-    void deleteEvent(string& title);
-    void shiftEvent(string& title, int newDate, Day* days);
+    void appendEvent(const Event& event); // for events that are already known to sort after and not overlap the stored ones
+    bool conflictsWith(const Event& event) const;
+    const Event* findConflict(const Event& event) const; // the stored event that the event would overlap, or nullptr
+    vector<const Event*> findConflicts(const Event& event) const; // every stored event that the event would overlap
+    const Event* findEvent(Title title) const; // returns nullptr if no event has the title
+    void deleteEvent(Title title);
+    void shiftEvent(Title title, Day& newDay);
     void clearEvents();
     string toString() const;
+    void appendText(string& output) const; // the text of toString() at the end of the output, nothing for a day without events
     bool toString_print() const;
     string formatDayDataToString() const;
-    void extractDayData(string& dayStr);
+    void appendDayData(string& output) const; // the lines of formatDayDataToString() at the end of the output
 };
\ No newline at end of file
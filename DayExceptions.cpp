@@ -1,23 +1,22 @@
 #include "DayExceptions.h"
 
 DayExceptions::DayExceptions(int code) : Exceptions(code) { // Constructor for the DayExceptions class
-    switch (errorCode) {
+    errorMessage = message(code);
+}
+
+const char* DayExceptions::message(int code) {
+    switch (code) {
     case 1:
-        errorMessage = "Cannot schedule events on a day off";
-        break;
+        return "Cannot schedule events on a day off";
     case 2:
-        errorMessage = "Unable to open file for loading";
-        break;
+        return "Unable to open file for loading";
     case 3:
-        errorMessage = "Invalid day for viewing schedule";
-        break;
+        return "Invalid day for viewing schedule";
     case 4:
-        errorMessage = "Cannot schedule events in the past or beyond July 2024";
-        break;
+        return "Cannot schedule events in the past";
     case 5:
-        errorMessage = "Invalid start day for viewing week schedule";
-        break;
+        return "Invalid start day for viewing week schedule";
     default:
-        errorMessage = "Day error";
+        return "Day error";
     }
 }
\ No newline at end of file
@@ -5,4 +5,5 @@
 class DayExceptions : public Exceptions { // Derived class for the DayExceptions
 public:
 	DayExceptions(int code);
+	static const char* message(int code);
 };
\ No newline at end of file
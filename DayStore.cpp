@@ -0,0 +1,161 @@
+#include "DayStore.h"
+
+using namespace std;
+
+DayStore::DayStore() {
+    this->segments = make_shared<SegmentTable>();
+    this->dayCount = 0;
+    this->changeCount = 0;
+    this->tableVersion = 0;
+    this->tableShared = false;
+    this->recording = nullptr;
+}
+
+DayStore::SegmentTable& DayStore::writableTable() {
+    if (tableShared || segments.use_count() > 1) { // readers never hold a table that was not published, so the count only moves on this thread
+        segments = make_shared<SegmentTable>(*segments);
+        tableVersion = changeCount;
+        tableShared = false;
+    }
+    return *segments;
+}
+
+DayStore::Segment* DayStore::writableSegment(int segmentNumber, bool create) {
+    if (!create && segments->count(segmentNumber) == 0) {
+        return nullptr;
+    }
+    SegmentTable& table = writableTable();
+    auto it = table.find(segmentNumber);
+    if (it == table.end()) {
+        it = table.emplace(segmentNumber, make_shared<Segment>()).first;
+    }
+    else if (it->second->version <= tableVersion) { // not written since the table was cloned, so a copy or a reader may still hold it
+        it->second = make_shared<Segment>(*it->second);
+    }
+    it->second->version = ++changeCount;
+    return it->second.get();
+}
+
+const Day* DayStore::find(int dayNumber) const {
+    auto segment = segments->find(segmentOf(dayNumber));
+    if (segment == segments->end()) {
+        return nullptr;
+    }
+    auto it = segment->second->days.find(dayNumber);
+    return it == segment->second->days.end() ? nullptr : &it->second;
+}
+
+void DayStore::keep(int dayNumber, const Day* day) {
+    if (recording != nullptr && recording->previous.count(dayNumber) == 0) {
+        recording->previous.emplace(dayNumber, day != nullptr ? optional<Day>(*day) : nullopt);
+    }
+}
+
+Day* DayStore::writableDay(int dayNumber) {
+    const Day* stored = find(dayNumber);
+    if (stored == nullptr) {
+        return nullptr; // looking for a day that is not stored does not clone anything
+    }
+    keep(dayNumber, stored);
+    Day& day = writableSegment(segmentOf(dayNumber), false)->days.at(dayNumber);
+    day.version = changeCount; // the caller may change the day through the pointer
+    return &day;
+}
+
+Day& DayStore::getOrCreate(int dayNumber) { // materialize the day the first time something is stored on it
+    keep(dayNumber, find(dayNumber));
+    map<int, Day>& days = writableSegment(segmentOf(dayNumber), true)->days;
+    auto it = days.find(dayNumber);
+    if (it == days.end()) {
+        it = days.emplace(dayNumber, Day(dayNumber)).first;
+        ++dayCount;
+    }
+    it->second.version = changeCount;
+    return it->second;
+}
+
+void DayStore::release(int dayNumber) {
+    const Day* day = find(dayNumber);
+    if (day == nullptr || !day->events.empty() || day->isDayOff) {
+        return;
+    }
+    keep(dayNumber, day);
+    erase(dayNumber);
+}
+
+void DayStore::erase(int dayNumber) {
+    int segmentNumber = segmentOf(dayNumber);
+    map<int, Day>& days = writableSegment(segmentNumber, false)->days;
+    days.erase(dayNumber);
+    --dayCount;
+    if (days.empty()) {
+        segments->erase(segmentNumber); // writableSegment() has made the table our own
+    }
+}
+
+void DayStore::store(Day day) {
+    int dayNumber = day.date;
+    Day& stored = getOrCreate(dayNumber);
+    uint64_t version = stored.version;
+    stored = move(day);
+    stored.version = version;
+    release(dayNumber);
+}
+
+int DayStore::size() const {
+    return dayCount;
+}
+
+void DayStore::markPublished() {
+    tableShared = true;
+}
+
+void DayStore::record(Change* change) {
+    recording = change;
+}
+
+void DayStore::revert(Change& change) { // Each day is stored again, so the segments get new versions and are saved with the next snapshot
+    for (auto it = change.previous.begin(); it != change.previous.end(); ++it) {
+        const Day* current = find(it->first);
+        optional<Day> replaced = (current != nullptr) ? optional<Day>(*current) : nullopt;
+        if (it->second.has_value()) {
+            store(move(*it->second));
+        }
+        else if (current != nullptr) {
+            erase(it->first);
+        }
+        it->second = move(replaced);
+    }
+}
+
+void DayStore::restore(const DayStore& version, Change& change) { // Only the segments whose pointers differ are looked at
+    change.previous.clear();
+    auto keepSegment = [&change](const Segment& segment, bool stored) { // the days of the current segment, or nothing for the days of the version
+        for (auto it = segment.days.begin(); it != segment.days.end(); ++it) {
+            change.previous.emplace(it->first, stored ? optional<Day>(it->second) : nullopt); // emplace keeps a day that is in both
+        }
+    };
+    auto current = segments->begin();
+    auto saved = version.segments->begin();
+    while (current != segments->end() || saved != version.segments->end()) {
+        if (saved == version.segments->end() || (current != segments->end() && current->first < saved->first)) {
+            keepSegment(*current->second, true); // added after the version was taken
+            ++current;
+        }
+        else if (current == segments->end() || saved->first < current->first) {
+            keepSegment(*saved->second, false); // dropped since
+            ++saved;
+        }
+        else {
+            if (current->second != saved->second) {
+                keepSegment(*current->second, true);
+                keepSegment(*saved->second, false);
+            }
+            ++current;
+            ++saved;
+        }
+    }
+    segments = version.segments; // the segments keep the versions they had, which differ from every version saved since
+    tableShared = true;
+    dayCount = version.dayCount;
+}
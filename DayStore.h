@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include "Day.h"
+
+using namespace std;
+
+/*
+ * Sparse store of the days keyed by the absolute day number.
+ *
+ * The days are grouped into segments of 32 consecutive day numbers, each held by a shared_ptr, and the table of
+ * segments is held by a shared_ptr as well. Copying the store only copies that pointer. The table and a segment
+ * that are shared with a copy are cloned the first time they are written to, so a copy stays unchanged while the
+ * original is edited, and an edit clones the segment pointers and one segment instead of the calendar.
+ * Whether a segment is shared is decided by its version and not by its use_count(), which readers on other threads
+ * move without ordering: after markPublished() the first write clones the table, and from then on only the segments
+ * stamped after that clone are written in place.
+ *
+ * While a Change is recorded, the first write access to each day keeps a copy of the day as it was before. Putting
+ * those back undoes the change at the cost of the days it touched. Copies are only ever read, so a copy that was
+ * made during a recording never adds to it.
+ *
+ * Every write access stamps the segment and the day with the next value of a change counter, so a segment
+ * whose version has not moved since it was saved or drawn is known to be unchanged. find() is read only and never
+ * does, so checks that may still reject a change leave the versions where they were.
+ */
+class DayStore {
+public:
+    static const int SEGMENT_DAYS = 32;
+
+    struct Segment {
+        map<int, Day> days;
+        uint64_t version; // changeCount at the last write access to one of the days
+    };
+
+    struct Change { // the days a change touched, as they were before it
+        map<int, optional<Day>> previous; // nullopt for a day that was not stored
+    };
+
+private:
+    typedef map<int, shared_ptr<Segment>> SegmentTable; // keyed by segment number, only segments that hold a day are kept
+
+    shared_ptr<SegmentTable> segments;
+    int dayCount;
+    uint64_t changeCount;
+    uint64_t tableVersion; // changeCount when the table was cloned, the segments stamped after it are in no other table
+    bool tableShared; // published or restored since the table was cloned, so other threads may hold it
+    Change* recording; // nullptr unless a change is being recorded
+
+    SegmentTable& writableTable(); // clones the table if a copy of the store still uses it
+    void keep(int dayNumber, const Day* day); // copy the day into the recorded change before its first write access
+    void erase(int dayNumber);
+
+    Segment* writableSegment(int segmentNumber, bool create); // clones the segment if a copy of the store still uses it, and stamps it
+
+public:
+    DayStore();
+
+    static int segmentOf(int dayNumber) { return dayNumber >= 0 ? dayNumber / SEGMENT_DAYS : (dayNumber + 1) / SEGMENT_DAYS - 1; }
+
+    const Day* find(int dayNumber) const; // returns nullptr if nothing is stored for the day
+    Day* writableDay(int dayNumber); // the stored day for a change, cloned and stamped; take it only once the change is accepted
+    Day& getOrCreate(int dayNumber);
+    void release(int dayNumber); // drop the day again once it holds nothing worth storing
+    void store(Day day); // put a day that was built elsewhere in place of the stored one
+    int size() const;
+    uint64_t version() const { return changeCount; } // moves on with every write access to any day
+    void markPublished(); // a copy was handed to readers, the next write clones the table and every segment it touches
+
+    void record(Change* change); // keep the days as they were before each first write access in the change, nullptr stops
+    void revert(Change& change); // put the recorded days back, the change then holds the ones it replaced so reverting it again redoes it
+    void restore(const DayStore& version, Change& change); // go back to a copy of the store, recording the days of the segments that differ from it
+
+    template <typename Function>
+    void forEachInRange(int firstDay, int lastDay, Function function) const { // visit the stored days in [firstDay, lastDay] in date order
+        for (auto segment = segments->lower_bound(segmentOf(firstDay)); segment != segments->end() && segment->first <= segmentOf(lastDay); ++segment) {
+            const map<int, Day>& days = segment->second->days;
+            for (auto it = days.lower_bound(firstDay); it != days.end() && it->first <= lastDay; ++it) {
+                function(it->second);
+            }
+        }
+    }
+
+    template <typename Function>
+    void forEach(Function function) const { // visit every stored day in date order
+        for (auto segment = segments->begin(); segment != segments->end(); ++segment) {
+            for (auto it = segment->second->days.begin(); it != segment->second->days.end(); ++it) {
+                function(it->second);
+            }
+        }
+    }
+
+    template <typename Function>
+    void forEachSegment(Function function) const { // visit every segment in order as function(segmentNumber, segment)
+        for (auto segment = segments->begin(); segment != segments->end(); ++segment) {
+            function(segment->first, (const Segment&)*segment->second);
+        }
+    }
+};
@@ -1,43 +1,90 @@
 #include "Event.h"
 #include "EventExceptions.h"
+#include "TextParser.h"
 
-#include <sstream>
 #include <iostream>
 
 using namespace std;
 
-Event::Event(string title, Time startTime, Time endTime, string repeatType) {
+const char* repeatTypeToString(RepeatType repeatType) {
+    switch (repeatType) {
+    case RepeatType::Daily:
+        return "daily";
+    case RepeatType::Weekly:
+        return "weekly";
+    default:
+        return "none";
+    }
+}
+
+RepeatType repeatTypeFromString(string_view repeatString) {
+    if (repeatString == "daily") return RepeatType::Daily;
+    if (repeatString == "weekly") return RepeatType::Weekly;
+    return RepeatType::None;
+}
+
+Event::Event(Title title, Time startTime, Time endTime, RepeatType repeatType) {
     this->title = title;
     this->startTime = startTime;
     this->endTime = endTime;
     this->repeatType = repeatType;
 
-    if (endTime.isSmallerComparedTo(startTime)) {
+    if (endTime < startTime) {
         throw EventExceptions(6);
     }
 }
 
-bool Event::overlaps(Event& comparisonEvent) const { // check if the event overlaps with another event
-    return (startTime.isSmallerComparedTo(comparisonEvent.endTime) && endTime.isLargerComparedTo(comparisonEvent.startTime));
+Expected<Event> Event::make(Title title, Time startTime, Time endTime, RepeatType repeatType) {
+    if (endTime < startTime) {
+        return Status(ErrorKind::Event, 6);
+    }
+    return Event(title, startTime, endTime, repeatType);
+}
+
+bool Event::overlaps(const Event& comparisonEvent) const { // check if the event overlaps with another event
+    return startTime < comparisonEvent.endTime && endTime > comparisonEvent.startTime;
 }
 
 string Event::toString() const { // return the event as a string
-    return "         " + title + " from " + startTime.toString() + " to " + endTime.toString() + " (" + repeatType + ")";
+    string eventString;
+    appendText(eventString);
+    return eventString;
 }
 
-string Event::formatEventDataToString() const { // format the event data to a string
-    return title + "|" + startTime.toString() + "|" + endTime.toString() + "|" + repeatType;
+void Event::appendText(string& output) const {
+    char time[5];
+    output += "         ";
+    output += title.view();
+    output += " from ";
+    startTime.writeTo(time);
+    output.append(time, 5);
+    output += " to ";
+    endTime.writeTo(time);
+    output.append(time, 5);
+    output += " (";
+    output += repeatTypeToString(repeatType);
+    output += ')';
 }
 
-void Event::extractEventData(const string& eventString) {
-    stringstream eventStream(eventString);
-    getline(eventStream, title, '|');  // Here is another use of stringstream, where we can use string handling functions like getline(), where the first parameter should insert as stream.
+string Event::formatEventDataToString() const { // format the event data to a string
+    string eventString;
+    appendEventData(eventString);
+    return eventString;
+}
 
-    string startTimeString, endTimeString;
-    getline(eventStream, startTimeString, '|');
-    getline(eventStream, endTimeString, '|');
-    getline(eventStream, repeatType);
+void Event::appendEventData(string& output) const {
+    char times[13] = "|HH:MM|HH:MM";
+    startTime.writeTo(times + 1);
+    endTime.writeTo(times + 7);
+    output += title.view();
+    output.append(times, 12);
+    output += '|';
+    output += repeatTypeToString(repeatType);
+}
 
-    startTime.fromString(startTimeString);
-    endTime.fromString(endTimeString);
+void Event::extractEventData(string_view eventString) { // title|HH:MM|HH:MM|repeat
+    title = Title(TextParser::nextField(eventString, '|'));
+    startTime.fromString(TextParser::nextField(eventString, '|'));
+    endTime.fromString(TextParser::nextField(eventString, '|'));
+    repeatType = repeatTypeFromString(TextParser::nextField(eventString, '|'));
 }
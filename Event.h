@@ -1,25 +1,39 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include "Time.h"
+#include "StringPool.h"
 #include "EventExceptions.h"
 
 using namespace std;
 
+enum class RepeatType : uint8_t { None, Daily, Weekly };
+
+const char* repeatTypeToString(RepeatType repeatType); // "none", "daily", "weekly"
+
+RepeatType repeatTypeFromString(string_view repeatString); // anything unknown is treated as "none"
+
 class Event { // Class for the Events
 public:
-    string title;
+    Title title; // interned, so copying an event copies no characters
     Time startTime;
     Time endTime;
-    string repeatType; // "none", "daily", "weekly"
+    RepeatType repeatType;
 
-    Event(string title = "EVENT", Time startTime = Time(), Time endTime = Time(), string repeatType = "none");
+    Event(Title title = Title::defaultTitle(), Time startTime = Time(), Time endTime = Time(), RepeatType repeatType = RepeatType::None);
 
-    bool overlaps(Event& comparisonEvent) const;
+    static Expected<Event> make(Title title, Time startTime, Time endTime, RepeatType repeatType); // the event, or EventExceptions code 6 instead of throwing
+
+    bool overlaps(const Event& comparisonEvent) const;
 
     string toString() const;
+    void appendText(string& output) const; // the text of toString() at the end of the output
 
     string formatEventDataToString() const;
 
-    void extractEventData(const string& eventString);
+    void appendEventData(string& output) const; // title|HH:MM|HH:MM|repeat at the end of the output
+
+    void extractEventData(string_view eventString);
 };
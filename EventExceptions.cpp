@@ -1,29 +1,24 @@
 #include "EventExceptions.h"
 
 EventExceptions::EventExceptions(int code) : Exceptions(code) { // Constructor for the EventExceptions class
-    switch (errorCode) {
+    errorMessage = message(code);
+}
+
+const char* EventExceptions::message(int code) { // the messages are shared with Status, which reports the same codes without throwing
+    switch (code) {
     case 1:
-        errorMessage = "Event overlaps with an existing event";
-        break;
-    case 2:
-        errorMessage = "Maximum number of events reached for a day";
-        break;
+        return "Event overlaps with an existing event";
     case 3:
-        errorMessage = "No such event exists";
-        break;
+        return "No such event exists";
     case 4:
-        errorMessage = "Cannot schedule events on a day off";
-        break;
+        return "Cannot schedule events on a day off";
     case 5:
-        errorMessage = "Invalid date for shifting events";
-        break;
+        return "Invalid date for shifting events";
     case 6:
-        errorMessage = "Event end time must be after start time";
-        break;
+        return "Event end time must be after start time";
     case 7:
-        errorMessage = "Event overlaps with an existing event on the new date";
-        break;
+        return "Event overlaps with an existing event on the new date";
     default:
-        errorMessage = "Event error";
+        return "Event error";
     }
 }
\ No newline at end of file
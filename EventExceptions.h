@@ -5,4 +5,5 @@
 class EventExceptions : public Exceptions { // Derived class for the EventExceptions
 public:
 	EventExceptions(int code);
+	static const char* message(int code);
 };
\ No newline at end of file
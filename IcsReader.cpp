@@ -0,0 +1,508 @@
+#include "IcsReader.h"
+
+#include <climits>
+#include <cstring>
+#include "Date.h"
+#include "RecurrenceRule.h"
+#include "TextParser.h"
+
+using namespace std;
+
+static bool equalsIgnoreCase(string_view text, const char* upper) { // compare with an upper case name of the format
+    size_t length = strlen(upper);
+    if (text.size() != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        if (c >= 'a' && c <= 'z') {
+            c = (char)(c - 'a' + 'A');
+        }
+        if (c != upper[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool splitContentLine(string_view line, string_view& name, string_view& parameters, string_view& value) { // NAME;PARAM=x:value
+    size_t nameEnd = line.find_first_of(";:");
+    if (nameEnd == string_view::npos) {
+        return false;
+    }
+    bool quoted = false; // a quoted parameter value may hold a ':'
+    size_t valueStart = nameEnd;
+    while (valueStart < line.size() && (line[valueStart] != ':' || quoted)) {
+        if (line[valueStart] == '"') {
+            quoted = !quoted;
+        }
+        ++valueStart;
+    }
+    if (valueStart == line.size()) {
+        return false;
+    }
+    name = line.substr(0, nameEnd);
+    parameters = line.substr(nameEnd, valueStart - nameEnd);
+    value = line.substr(valueStart + 1);
+    return true;
+}
+
+static bool parseNumber(string_view text, int maximum, int& number) { // digits only, at most the maximum
+    if (text.empty()) {
+        return false;
+    }
+    long long parsed = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        parsed = parsed * 10 + (c - '0');
+        if (parsed > maximum) {
+            return false;
+        }
+    }
+    number = (int)parsed;
+    return true;
+}
+
+static void report(IcsEvent& event, const string& problem) { // the first problem of the event is the one reported
+    if (event.problem.empty()) {
+        event.problem = problem;
+    }
+}
+
+IcsReader::IcsReader(const string& path) : file(path, ios::binary), buffer(BUFFER_SIZE) {
+    position = 0;
+    filled = 0;
+    lineNumber = 0;
+    atEnd = false;
+    contentTooLong = false;
+    hasStart = false;
+    startHasTime = false;
+    startMinutes = 0;
+    hasEnd = false;
+    endDate = 0;
+    endMinutes = 0;
+    hasDuration = false;
+    durationMinutes = 0;
+}
+
+bool IcsReader::peek(char& c) {
+    if (position == filled) {
+        if (atEnd) {
+            return false;
+        }
+        file.read(buffer.data(), (streamsize)buffer.size());
+        filled = (size_t)file.gcount();
+        position = 0;
+        if (filled == 0) {
+            atEnd = true;
+            return false;
+        }
+    }
+    c = buffer[position];
+    return true;
+}
+
+bool IcsReader::readPhysicalLine(string& line, bool& tooLong) {
+    char c;
+    if (!peek(c)) {
+        return false;
+    }
+    ++lineNumber;
+    while (peek(c)) {
+        const char* start = buffer.data() + position;
+        const char* newline = (const char*)memchr(start, '\n', filled - position);
+        size_t length = (newline != nullptr) ? (size_t)(newline - start) : filled - position;
+        size_t room = (line.size() < MAX_LINE_LENGTH) ? MAX_LINE_LENGTH - line.size() : 0;
+        if (length > room) {
+            tooLong = true;
+        }
+        line.append(start, length < room ? length : room);
+        position += length;
+        if (newline != nullptr) {
+            ++position;
+            break;
+        }
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
+
+bool IcsReader::readContentLine() {
+    contentLine.clear();
+    contentTooLong = false;
+    if (!readPhysicalLine(contentLine, contentTooLong)) {
+        return false;
+    }
+    if (lineNumber == 1 && contentLine.compare(0, 3, "\xEF\xBB\xBF") == 0) { // byte order mark
+        contentLine.erase(0, 3);
+    }
+    char c;
+    while (peek(c) && (c == ' ' || c == '\t')) { // a line that starts with a space continues the one before it
+        ++position;
+        readPhysicalLine(contentLine, contentTooLong);
+    }
+    return true;
+}
+
+bool IcsReader::next(IcsEvent& event) {
+    string_view name, parameters, value;
+    bool found = false;
+    while (!found && readContentLine()) { // everything outside the events, such as VTIMEZONE, is skipped
+        found = splitContentLine(contentLine, name, parameters, value) && equalsIgnoreCase(name, "BEGIN") && equalsIgnoreCase(value, "VEVENT");
+    }
+    if (!found) {
+        return false;
+    }
+
+    event.line = lineNumber;
+    event.title.clear();
+    event.date = 0;
+    event.startTime = Time();
+    event.endTime = Time();
+    event.repeatType = RepeatType::None;
+    event.period = 0;
+    event.lastDay = RecurrenceRule::NO_END;
+    event.exceptions.clear();
+    event.isDayOff = false;
+    event.problem.clear();
+    ruleText.clear();
+    hasStart = false;
+    startHasTime = false;
+    hasEnd = false;
+    hasDuration = false;
+
+    int depth = 0; // components inside the event, such as VALARM
+    while (readContentLine()) {
+        if (contentTooLong) {
+            report(event, "Line " + to_string(lineNumber) + " is too long");
+        }
+        if (!splitContentLine(contentLine, name, parameters, value)) {
+            continue;
+        }
+        if (equalsIgnoreCase(name, "BEGIN")) {
+            ++depth;
+        }
+        else if (equalsIgnoreCase(name, "END")) {
+            if (depth == 0) {
+                finishEvent(event);
+                return true;
+            }
+            --depth;
+        }
+        else if (depth == 0) {
+            readProperty(name, value, event);
+        }
+    }
+    report(event, "The file ends inside the event");
+    return true;
+}
+
+void IcsReader::readProperty(string_view name, string_view value, IcsEvent& event) { // the parameters are not needed: VALUE=DATE shows in the value, and TZID is not converted
+    if (equalsIgnoreCase(name, "SUMMARY")) {
+        event.title.clear();
+        unescapeText(value, event.title);
+    }
+    else if (equalsIgnoreCase(name, "DTSTART")) {
+        hasStart = parseDateTime(value, event.date, startMinutes, startHasTime);
+        if (!hasStart) {
+            report(event, "Invalid DTSTART");
+        }
+    }
+    else if (equalsIgnoreCase(name, "DTEND")) {
+        bool endHasTime = false;
+        hasEnd = parseDateTime(value, endDate, endMinutes, endHasTime);
+        if (!hasEnd) {
+            report(event, "Invalid DTEND");
+        }
+    }
+    else if (equalsIgnoreCase(name, "DURATION")) {
+        hasDuration = parseDuration(value, durationMinutes);
+        if (!hasDuration) {
+            report(event, "Invalid DURATION");
+        }
+    }
+    else if (equalsIgnoreCase(name, "RRULE")) {
+        if (!ruleText.empty()) {
+            report(event, "More than one RRULE");
+        }
+        ruleText.assign(value.data(), value.size());
+    }
+    else if (equalsIgnoreCase(name, "EXDATE")) {
+        while (value.data() != nullptr) {
+            string_view field = TextParser::nextField(value, ',');
+            int date = 0, minutes = 0;
+            bool hasTime = false;
+            if (!parseDateTime(field, date, minutes, hasTime)) {
+                report(event, "Invalid EXDATE");
+                return;
+            }
+            event.exceptions.push_back(date);
+        }
+    }
+    else if (equalsIgnoreCase(name, "X-CALENDAR-DAY-OFF")) {
+        event.isDayOff = equalsIgnoreCase(value, "TRUE");
+    }
+    else if (equalsIgnoreCase(name, "RDATE")) {
+        report(event, "RDATE is not supported");
+    }
+    else if (equalsIgnoreCase(name, "RECURRENCE-ID")) {
+        report(event, "Changes one occurrence of a series");
+    }
+    else if (equalsIgnoreCase(name, "STATUS") && equalsIgnoreCase(value, "CANCELLED")) {
+        report(event, "The event is cancelled");
+    }
+}
+
+void IcsReader::finishEvent(IcsEvent& event) { // check the event against what the calendar can hold
+    if (!event.problem.empty()) {
+        return;
+    }
+    if (!hasStart) {
+        report(event, "Missing DTSTART");
+        return;
+    }
+    if (!startHasTime) { // an all-day event
+        if (!event.isDayOff) {
+            report(event, "All-day events are not supported");
+        }
+        else if (!ruleText.empty()) {
+            report(event, "Repeating days off are not supported");
+        }
+        return;
+    }
+    if (event.isDayOff) {
+        report(event, "A day off has no time");
+        return;
+    }
+    if (event.title.empty()) {
+        report(event, "The title is empty");
+        return;
+    }
+
+    long long end = startMinutes;
+    if (hasEnd) {
+        end = ((long long)endDate - event.date) * 1440 + endMinutes;
+    }
+    else if (hasDuration) {
+        end = (long long)startMinutes + durationMinutes;
+    }
+    if (end < startMinutes) {
+        report(event, "Ends before it starts");
+        return;
+    }
+    if (end > 1440) {
+        report(event, "Ends on a later day");
+        return;
+    }
+    if (end == 1440) { // an event that runs until midnight ends at the last minute of the day
+        end = 1439;
+    }
+    event.startTime = Time::fromMinutes(startMinutes);
+    event.endTime = Time::fromMinutes((int)end);
+
+    if (!ruleText.empty()) {
+        applyRule(event);
+    }
+    else {
+        event.exceptions.clear(); // only a series can leave out a day
+    }
+}
+
+void IcsReader::applyRule(IcsEvent& event) { // map FREQ, INTERVAL, COUNT, UNTIL and BYDAY onto a daily or weekly series
+    static const char* const DAY_CODES[] = { "SU", "MO", "TU", "WE", "TH", "FR", "SA" };
+
+    RepeatType repeatType = RepeatType::None;
+    int interval = 1;
+    int count = 0;
+    bool hasUntil = false;
+    int untilDate = 0, untilMinutes = 0;
+    bool untilHasTime = false;
+    string_view byDay;
+
+    string_view rest = ruleText;
+    while (rest.data() != nullptr) {
+        string_view part = TextParser::nextField(rest, ';');
+        size_t equals = part.find('=');
+        if (equals == string_view::npos) {
+            report(event, "Invalid RRULE");
+            return;
+        }
+        string_view name = part.substr(0, equals);
+        string_view value = part.substr(equals + 1);
+        bool valid = true;
+        if (equalsIgnoreCase(name, "FREQ")) {
+            if (equalsIgnoreCase(value, "DAILY")) {
+                repeatType = RepeatType::Daily;
+            }
+            else if (equalsIgnoreCase(value, "WEEKLY")) {
+                repeatType = RepeatType::Weekly;
+            }
+            else {
+                report(event, "Only daily and weekly series are supported");
+                return;
+            }
+        }
+        else if (equalsIgnoreCase(name, "INTERVAL")) {
+            valid = parseNumber(value, 100000, interval) && interval > 0;
+        }
+        else if (equalsIgnoreCase(name, "COUNT")) {
+            valid = parseNumber(value, INT_MAX, count) && count > 0;
+        }
+        else if (equalsIgnoreCase(name, "UNTIL")) {
+            valid = hasUntil = parseDateTime(value, untilDate, untilMinutes, untilHasTime);
+        }
+        else if (equalsIgnoreCase(name, "BYDAY")) {
+            byDay = value;
+        }
+        else if (!equalsIgnoreCase(name, "WKST")) { // the week start changes nothing for a single weekday
+            report(event, "RRULE part " + string(name) + " is not supported");
+            return;
+        }
+        if (!valid) {
+            report(event, "Invalid RRULE " + string(name));
+            return;
+        }
+    }
+    if (repeatType == RepeatType::None) {
+        report(event, "RRULE without FREQ");
+        return;
+    }
+    if (!byDay.empty() && (repeatType != RepeatType::Weekly || !equalsIgnoreCase(byDay, DAY_CODES[Date::dayOfWeek(event.date)]))) {
+        report(event, "Only series on the weekday of their start are supported");
+        return;
+    }
+
+    int period = RecurrenceRule::defaultPeriod(repeatType) * interval;
+    long long lastDay = RecurrenceRule::NO_END;
+    if (count > 0) {
+        lastDay = event.date + (long long)(count - 1) * period;
+    }
+    if (hasUntil) {
+        long long untilDay = (untilHasTime && untilMinutes < startMinutes) ? untilDate - 1LL : untilDate; // the occurrence on the UNTIL day starts too late
+        lastDay = min(lastDay, untilDay);
+    }
+    if (lastDay < event.date) {
+        report(event, "The series has no occurrences");
+        return;
+    }
+
+    event.repeatType = repeatType;
+    event.period = period;
+    event.lastDay = (lastDay >= RecurrenceRule::NO_END) ? RecurrenceRule::NO_END : (int)lastDay;
+    size_t kept = 0;
+    for (int exception : event.exceptions) { // dates that are not on the series change nothing
+        if (exception >= event.date && exception <= event.lastDay && (exception - event.date) % period == 0) {
+            event.exceptions[kept++] = exception;
+        }
+    }
+    event.exceptions.resize(kept);
+}
+
+bool IcsReader::parseDateTime(string_view text, int& date, int& minutes, bool& hasTime) {
+    auto digits = [&text](size_t start, size_t count, int& number) {
+        number = 0;
+        for (size_t i = start; i < start + count; ++i) {
+            if (text[i] < '0' || text[i] > '9') {
+                return false;
+            }
+            number = number * 10 + (text[i] - '0');
+        }
+        return true;
+    };
+
+    int year, month, day;
+    if (text.size() < 8 || !digits(0, 4, year) || !digits(4, 2, month) || !digits(6, 2, day) || year < Date::MIN_YEAR
+        || month < 1 || month > 12 || day < 1 || day > Date::daysInMonth(year, month)) {
+        return false;
+    }
+    date = Date(year, month, day).toDayNumber();
+    hasTime = (text.size() > 8);
+    minutes = 0;
+    if (!hasTime) {
+        return true;
+    }
+
+    int hour, minute, second;
+    if ((text.size() != 15 && (text.size() != 16 || text[15] != 'Z')) || text[8] != 'T'
+        || !digits(9, 2, hour) || !digits(11, 2, minute) || !digits(13, 2, second) || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    minutes = hour * 60 + minute;
+    return true;
+}
+
+bool IcsReader::parseDuration(string_view text, int& minutes) {
+    size_t i = 0;
+    if (i < text.size() && text[i] == '+') {
+        ++i;
+    }
+    if (i == text.size() || text[i] != 'P') {
+        return false;
+    }
+    ++i;
+
+    long long total = 0; // seconds
+    bool inTime = false;
+    bool hasPart = false;
+    while (i < text.size()) {
+        if (text[i] == 'T' && !inTime) {
+            inTime = true;
+            ++i;
+            continue;
+        }
+        long long number = 0;
+        size_t start = i;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9' && number < 100000000) {
+            number = number * 10 + (text[i] - '0');
+            ++i;
+        }
+        if (i == start || i == text.size()) {
+            return false;
+        }
+        char unit = text[i++];
+        if (!inTime && unit == 'W') {
+            total += number * 7 * 86400;
+        }
+        else if (!inTime && unit == 'D') {
+            total += number * 86400;
+        }
+        else if (inTime && unit == 'H') {
+            total += number * 3600;
+        }
+        else if (inTime && unit == 'M') {
+            total += number * 60;
+        }
+        else if (inTime && unit == 'S') {
+            total += number;
+        }
+        else {
+            return false;
+        }
+        if (total > (long long)INT_MAX) {
+            return false;
+        }
+        hasPart = true;
+    }
+    minutes = (int)(total / 60);
+    return hasPart;
+}
+
+void IcsReader::unescapeText(string_view text, string& output) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '\\' && i + 1 < text.size()) {
+            c = text[++i];
+            if (c == 'n' || c == 'N') {
+                c = ' ';
+            }
+        }
+        if (c == '|') {
+            c = '/';
+        }
+        output += c;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Event.h"
+#include "Time.h"
+
+using namespace std;
+
+struct IcsEvent { // One VEVENT of an iCalendar file, mapped onto the calendar
+    int line; // line of its BEGIN:VEVENT
+    string title;
+    int date; // day number of DTSTART
+    Time startTime;
+    Time endTime;
+    RepeatType repeatType; // None unless the event has an RRULE
+    int period; // days between two occurrences of a series
+    int lastDay; // RecurrenceRule::NO_END if the series never ends
+    vector<int> exceptions; // day numbers of the EXDATE lines
+    bool isDayOff; // an all-day event marked X-CALENDAR-DAY-OFF, as IcsWriter writes the days off
+    string problem; // why the event cannot be stored in the calendar, empty if it can
+};
+
+/*
+ * Reads the VEVENTs of an iCalendar (RFC 5545) file one at a time through a fixed buffer, so that a feed of any size
+ * is read in the memory of one event.
+ *
+ * DTSTART, DTEND or DURATION, SUMMARY, RRULE with FREQ=DAILY or FREQ=WEEKLY (INTERVAL, COUNT, UNTIL and a BYDAY of
+ * the first weekday) and EXDATE are mapped onto the calendar. Times are taken as the wall clock time they are written
+ * in, whatever their TZID or UTC suffix says. Everything else that would change when the event happens leaves the
+ * event with a problem instead, so that it is reported rather than stored wrong.
+ */
+class IcsReader {
+private:
+    static const size_t BUFFER_SIZE = 1 << 16;
+    static const size_t MAX_LINE_LENGTH = 1 << 16; // the rest of a longer line is skipped and the event is reported
+
+    ifstream file;
+    vector<char> buffer;
+    size_t position;
+    size_t filled;
+    int lineNumber; // of the physical line read last
+    bool atEnd;
+    string contentLine; // the unfolded line that is being looked at
+    bool contentTooLong;
+    string ruleText; // RRULE of the current event, mapped once DTSTART is known
+
+    // The times of the current event, resolved into the event at its END:VEVENT
+    bool hasStart;
+    bool startHasTime; // false for an all-day DTSTART
+    int startMinutes;
+    bool hasEnd;
+    int endDate;
+    int endMinutes;
+    bool hasDuration;
+    int durationMinutes;
+
+    bool readPhysicalLine(string& line, bool& tooLong); // appends the line without its line break, false at the end of the file
+    bool peek(char& c); // the next character without reading it, false at the end of the file
+    bool readContentLine(); // the next line with its folded continuations, false at the end of the file
+    void readProperty(string_view name, string_view value, IcsEvent& event);
+    void finishEvent(IcsEvent& event);
+    void applyRule(IcsEvent& event);
+
+public:
+    IcsReader(const string& path);
+
+    bool isOpen() const { return file.is_open(); }
+    bool next(IcsEvent& event); // false once every event is read
+    int currentLine() const { return lineNumber; }
+
+    static bool parseDateTime(string_view text, int& date, int& minutes, bool& hasTime); // YYYYMMDD or YYYYMMDDTHHMMSS with an optional Z
+    static bool parseDuration(string_view text, int& minutes); // [+]P[nW][nD][T[nH][nM][nS]], the seconds are dropped
+    static void unescapeText(string_view text, string& output); // SUMMARY text, line breaks become spaces and '|' becomes '/' for the text format
+};
@@ -0,0 +1,170 @@
+#include "IcsWriter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <vector>
+#include "Date.h"
+
+using namespace std;
+
+static const int LAST_DAY = Date(Date::MAX_YEAR, 12, 31).toDayNumber();
+
+static char* writeDigits(char* output, int number, int count) { // the number with leading zeros
+    for (int i = count - 1; i >= 0; --i) {
+        output[i] = (char)('0' + number % 10);
+        number /= 10;
+    }
+    return output + count;
+}
+
+static char* writeDate(char* output, int dayNumber) { // YYYYMMDD
+    Date date = Date::fromDayNumber(dayNumber);
+    output = writeDigits(output, date.year, 4);
+    output = writeDigits(output, date.month, 2);
+    return writeDigits(output, date.day, 2);
+}
+
+IcsWriter::IcsWriter() {
+    long long now = (long long)time(nullptr); // seconds since 1970-01-01 UTC, the same origin as the day numbers
+    int secondOfDay = (int)(now % 86400);
+    char* end = writeDate(stamp, (int)(now / 86400));
+    *end++ = 'T';
+    end = writeDigits(end, secondOfDay / 3600, 2);
+    end = writeDigits(end, secondOfDay / 60 % 60, 2);
+    end = writeDigits(end, secondOfDay % 60, 2);
+    *end = 'Z';
+}
+
+void IcsWriter::appendLine(string& output) {
+    size_t start = 0;
+    size_t limit = MAX_LINE_OCTETS;
+    while (line.size() - start > limit) {
+        size_t end = start + limit;
+        while (end > start + 1 && ((unsigned char)line[end] & 0xC0) == 0x80) { // never split a UTF-8 character
+            --end;
+        }
+        output.append(line, start, end - start);
+        output += "\r\n ";
+        start = end;
+        limit = MAX_LINE_OCTETS - 1; // the space that starts a continuation line counts
+    }
+    output.append(line, start, string::npos);
+    output += "\r\n";
+}
+
+void IcsWriter::appendDate(int date) {
+    char text[8];
+    line.append(text, writeDate(text, date));
+}
+
+void IcsWriter::appendDateTime(int date, Time time) {
+    char text[15];
+    char* end = writeDate(text, date);
+    *end++ = 'T';
+    end = writeDigits(end, time.getHour(), 2);
+    end = writeDigits(end, time.getMinute(), 2);
+    end = writeDigits(end, 0, 2);
+    line.append(text, end);
+}
+
+void IcsWriter::appendEventLines(string& output, int date, const Event& event) {
+    line.assign("DTSTAMP:").append(stamp, sizeof(stamp));
+    appendLine(output);
+    line.assign("DTSTART:");
+    appendDateTime(date, event.startTime);
+    appendLine(output);
+    line.assign("DTEND:");
+    appendDateTime(date, event.endTime);
+    appendLine(output);
+
+    line.assign("SUMMARY:");
+    for (char c : event.title.view()) {
+        if (c == '\\' || c == ';' || c == ',') {
+            line += '\\';
+        }
+        line += c;
+    }
+    appendLine(output);
+}
+
+void IcsWriter::appendHeader(string& output) const {
+    output += "BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//Console-Based-Calendar-Application//EN\r\nCALSCALE:GREGORIAN\r\n";
+}
+
+void IcsWriter::appendFooter(string& output) const {
+    output += "END:VCALENDAR\r\n";
+}
+
+void IcsWriter::appendEvent(string& output, int date, const Event& event, int index) {
+    output += "BEGIN:VEVENT\r\n";
+    line.assign("UID:");
+    appendDate(date);
+    line += '-';
+    char number[12];
+    line.append(number, to_chars(number, number + sizeof(number), index).ptr);
+    line += "@calendar";
+    appendLine(output);
+    appendEventLines(output, date, event);
+    output += "END:VEVENT\r\n";
+}
+
+void IcsWriter::appendDayOff(string& output, int date) {
+    output += "BEGIN:VEVENT\r\n";
+    line.assign("UID:");
+    appendDate(date);
+    line += "-off@calendar";
+    appendLine(output);
+    line.assign("DTSTAMP:").append(stamp, sizeof(stamp));
+    appendLine(output);
+    line.assign("DTSTART;VALUE=DATE:");
+    appendDate(date);
+    appendLine(output);
+    if (date < LAST_DAY) { // without DTEND an all-day event lasts one day, and the day after the last one has no date
+        line.assign("DTEND;VALUE=DATE:");
+        appendDate(date + 1);
+        appendLine(output);
+    }
+    output += "SUMMARY:Day off\r\nTRANSP:OPAQUE\r\nX-CALENDAR-DAY-OFF:TRUE\r\nEND:VEVENT\r\n";
+}
+
+void IcsWriter::appendRule(string& output, const RecurrenceRule& rule) {
+    output += "BEGIN:VEVENT\r\n";
+    line.assign("UID:series-");
+    char number[12];
+    line.append(number, to_chars(number, number + sizeof(number), rule.id).ptr);
+    line += "@calendar";
+    appendLine(output);
+    appendEventLines(output, rule.firstDay, rule.event);
+
+    RepeatType frequency = rule.event.repeatType;
+    int interval = rule.period / RecurrenceRule::defaultPeriod(frequency);
+    if (rule.period % RecurrenceRule::defaultPeriod(frequency) != 0) { // a weekly series every few days is written as a daily one
+        frequency = RepeatType::Daily;
+        interval = rule.period;
+    }
+    line.assign(frequency == RepeatType::Daily ? "RRULE:FREQ=DAILY" : "RRULE:FREQ=WEEKLY");
+    if (interval > 1) {
+        line += ";INTERVAL=";
+        line.append(number, to_chars(number, number + sizeof(number), interval).ptr);
+    }
+    if (rule.lastDay != RecurrenceRule::NO_END) {
+        line += ";UNTIL=";
+        appendDateTime(rule.lastDay, Time(23, 59)); // UNTIL takes the type of DTSTART, a floating date and time
+    }
+    appendLine(output);
+
+    if (!rule.exceptions.empty()) {
+        vector<int> sortedExceptions(rule.exceptions.begin(), rule.exceptions.end());
+        sort(sortedExceptions.begin(), sortedExceptions.end());
+        line.assign("EXDATE:");
+        for (size_t i = 0; i < sortedExceptions.size(); ++i) {
+            if (i > 0) {
+                line += ',';
+            }
+            appendDateTime(sortedExceptions[i], rule.event.startTime);
+        }
+        appendLine(output);
+    }
+    output += "END:VEVENT\r\n";
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include "Event.h"
+#include "RecurrenceRule.h"
+
+using namespace std;
+
+/*
+ * Formats the calendar as iCalendar (RFC 5545) text at the end of the caller's buffer, which the caller writes out
+ * whenever it is full, so that an export of any size needs the memory of one buffer.
+ *
+ * Every event is a VEVENT in floating local time. A series carries its RRULE and EXDATE lines, and a day off is an
+ * all-day VEVENT marked X-CALENDAR-DAY-OFF so that IcsReader can read it back.
+ */
+class IcsWriter {
+private:
+    static const size_t MAX_LINE_OCTETS = 75; // longer lines are folded onto continuation lines
+
+    char stamp[16]; // DTSTAMP of every event, the time of the export in UTC
+    string line; // the content line that is being formatted
+
+    void appendLine(string& output); // the line, folded and ended with CRLF
+    void appendDate(int date); // YYYYMMDD to the line
+    void appendDateTime(int date, Time time); // YYYYMMDDTHHMM00 to the line
+    void appendEventLines(string& output, int date, const Event& event); // DTSTAMP, DTSTART, DTEND and SUMMARY
+
+public:
+    IcsWriter();
+
+    void appendHeader(string& output) const;
+    void appendFooter(string& output) const;
+    void appendEvent(string& output, int date, const Event& event, int index); // a single event, index is its place in the day
+    void appendDayOff(string& output, int date);
+    void appendRule(string& output, const RecurrenceRule& rule);
+};
@@ -0,0 +1,168 @@
+#include "Journal.h"
+#include "Date.h"
+#include "SchedulerExceptions.h"
+#include "TextParser.h"
+#include "Stats.h"
+
+#include <charconv>
+#include <cstring>
+
+using namespace std;
+
+JournalRecord::JournalRecord(char kind, int date) {
+    this->sequence = 0;
+    this->kind = kind;
+    this->date = date;
+    this->newDate = date;
+    this->flag = false;
+}
+
+string JournalRecord::formatRecordToString() const {
+    string line = to_string(sequence) + "|" + kind + "|" + Date::fromDayNumber(date).toString();
+    switch (kind) {
+    case 'S':
+        line += string("|") + (flag ? "1" : "0") + "|" + event.formatEventDataToString();
+        break;
+    case 'C':
+        line += string("|") + (flag ? "1" : "0") + "|" + event.title.toString();
+        break;
+    case 'M':
+        line += "|" + Date::fromDayNumber(newDate).toString() + "|" + event.title.toString();
+        break;
+    }
+    return line + "\n";
+}
+
+bool JournalRecord::extractRecordData(string_view line) {
+    string_view sequenceField = TextParser::nextField(line, '|');
+    string_view kindField = TextParser::nextField(line, '|');
+    auto result = from_chars(sequenceField.data(), sequenceField.data() + sequenceField.size(), sequence);
+    if (result.ec != errc() || kindField.size() != 1 || !TextParser::parseDate(TextParser::nextField(line, '|'), date)) {
+        return false;
+    }
+    kind = kindField[0];
+    newDate = date;
+
+    switch (kind) {
+    case 'S':
+        flag = (TextParser::nextField(line, '|') == "1");
+        if (line.data() == nullptr) {
+            return false;
+        }
+        try {
+            event.extractEventData(line);
+        }
+        catch (const exception&) { // a time that does not parse
+            return false;
+        }
+        return true;
+    case 'C':
+        flag = (TextParser::nextField(line, '|') == "1");
+        event.title = Title(line); // the title is the last field, so it may contain '|'
+        return !event.title.empty();
+    case 'M':
+        if (!TextParser::parseDate(TextParser::nextField(line, '|'), newDate)) {
+            return false;
+        }
+        event.title = Title(line);
+        return !event.title.empty();
+    case 'O':
+        return true;
+    default:
+        return false;
+    }
+}
+
+Journal::Journal(const string& path) {
+    this->path = path;
+    this->pendingRecords = 0;
+    this->lastSequence = 0;
+    this->storedRecords = 0;
+    this->storedLength = 0;
+}
+
+vector<JournalRecord> Journal::open(uint32_t snapshotSequence, bool forAppending) {
+    vector<JournalRecord> records;
+    lastSequence = snapshotSequence;
+    storedRecords = 0;
+
+    size_t validLength = 0; // the file is cut back to the last complete record
+    size_t fileLength = 0;
+    MappedFile mapped;
+    if (mapped.open(path) && mapped.begin() != nullptr) {
+        const char* data = mapped.begin();
+        fileLength = mapped.size();
+        while (validLength < fileLength) {
+            const char* lineEnd = static_cast<const char*>(memchr(data + validLength, '\n', fileLength - validLength));
+            if (lineEnd == nullptr) {
+                break; // the last record was torn by a crash while it was being written
+            }
+            JournalRecord record;
+            if (!record.extractRecordData(string_view(data + validLength, (size_t)(lineEnd - data) - validLength))) {
+                break;
+            }
+            validLength = (size_t)(lineEnd - data) + 1;
+            ++storedRecords;
+            if (record.sequence > snapshotSequence) { // older records were compacted before the journal could be emptied
+                records.push_back(record);
+                lastSequence = record.sequence;
+            }
+        }
+    }
+    mapped.close();
+
+    if (!forAppending) {
+        return records;
+    }
+    if (!file.open(path) || (validLength < fileLength && !file.truncate(validLength))) {
+        throw SchedulerExceptions(4);
+    }
+    storedLength = validLength;
+    return records;
+}
+
+void Journal::append(JournalRecord record) {
+    record.sequence = ++lastSequence;
+    if (pendingRecords == 0) {
+        firstPendingTime = chrono::steady_clock::now();
+    }
+    pending += record.formatRecordToString();
+    ++pendingRecords;
+}
+
+bool Journal::isCommitDue() const {
+    return pendingRecords >= GROUP_COMMIT_RECORDS
+        || (pendingRecords > 0 && chrono::steady_clock::now() - firstPendingTime >= chrono::milliseconds(GROUP_COMMIT_MILLISECONDS));
+}
+
+void Journal::sync() {
+    if (pendingRecords == 0) {
+        return;
+    }
+    StatsTimer timer(StatOperation::JournalSync); // only the syncs that write something
+    if (!file.isOpen() || !file.write(pending.data(), pending.size()) || !file.flushToDisk()) {
+        if (file.isOpen()) {
+            file.truncate(storedLength); // do not leave half a batch in front of the retry
+        }
+        throw SchedulerExceptions(4); // the records stay pending and are written with the next sync
+    }
+    storedRecords += pendingRecords;
+    storedLength += pending.size();
+    pending.clear();
+    pendingRecords = 0;
+}
+
+bool Journal::needsCompaction(int calendarSize) const {
+    int records = storedRecords + pendingRecords;
+    return records >= COMPACTION_RECORDS && records >= calendarSize;
+}
+
+void Journal::clear() {
+    pending.clear();
+    pendingRecords = 0;
+    storedRecords = 0;
+    storedLength = 0;
+    if (file.isOpen()) {
+        file.truncate(); // replay skips the records anyway, the snapshot holds their sequence
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Event.h"
+#include "Platform.h"
+
+using namespace std;
+
+/*
+ * Write-ahead journal of the changes made since the last snapshot.
+ *
+ * Every change is one text line that starts with its sequence number:
+ *
+ *   seq|S|YYYY-MM-DD|override|title|HH:MM|HH:MM|repeat    schedule (override = 1 if a day off was given up for it)
+ *   seq|C|YYYY-MM-DD|deleteRepeats|title                  cancel
+ *   seq|M|YYYY-MM-DD|YYYY-MM-DD|title                     shift to the second date
+ *   seq|O|YYYY-MM-DD                                      day off
+ *
+ * Lines are collected in memory and written with a single fsync once enough of them are waiting or the
+ * oldest has waited long enough (group commit). The snapshot remembers the last sequence it contains, so
+ * replay skips the lines that were already compacted into it and stops at a line torn by a crash.
+ */
+
+struct JournalRecord { // One change read from or written to the journal
+    uint32_t sequence;
+    char kind; // 'S' schedule, 'C' cancel, 'M' shift, 'O' day off
+    int date;
+    int newDate; // target of a shift
+    bool flag; // override of a schedule, deleteRepeats of a cancel
+    Event event; // only the title is used by cancel and shift
+
+    JournalRecord(char kind = 'O', int date = 0);
+
+    string formatRecordToString() const;
+    bool extractRecordData(string_view line); // returns false if the line is not a complete record
+};
+
+class Journal {
+public:
+    static constexpr int GROUP_COMMIT_RECORDS = 32; // write out once this many records are waiting
+    static constexpr int GROUP_COMMIT_MILLISECONDS = 200; // or once the oldest waiting record is this old
+    static constexpr int COMPACTION_RECORDS = 1024; // the journal is never folded into the snapshot before it holds this many records
+
+private:
+    string path;
+    AppendFile file;
+    string pending; // records that are not written yet
+    int pendingRecords;
+    chrono::steady_clock::time_point firstPendingTime;
+    uint32_t lastSequence;
+    int storedRecords; // records in the file since the last compaction
+    size_t storedLength; // bytes of complete records in the file
+
+public:
+    Journal(const string& path);
+
+    // Returns the records newer than the snapshot and opens the file for appending, unless the calendar is only read
+    vector<JournalRecord> open(uint32_t snapshotSequence, bool forAppending = true);
+    void append(JournalRecord record); // assigns the next sequence number
+    bool isCommitDue() const;
+    void sync(); // write the waiting records and flush them to the disk
+    bool needsCompaction(int calendarSize) const; // once the journal is as long as the calendar, so each change pays a constant share of the snapshot
+    void clear(); // drop every record once a snapshot holds them
+    uint32_t sequence() const { return lastSequence; }
+};
@@ -1,37 +1,53 @@
 #include "Time.h"
+#include "Date.h"
 #include "Exceptions.h"
 #include "Event.h"
 #include "Day.h"
 #include "Scheduler.h"
+#include "CommonFreeTime.h"
+#include "CommandProcessor.h"
+#include "Daemon.h"
 #include "EventExceptions.h"
 #include "DayExceptions.h"
 #include "SchedulerExceptions.h"
 #include "TimeExceptions.h" 
+#include "DateExceptions.h"
 
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <limits>
 
 using namespace std;
 
 
-int validateInput_currentDay(int startValue, int endValue, const string& instruct) { // Validate the input for the current day
-    int input;
+int validateDate(const Date& month, int earliestDay, const string& instruct, int color = 15) { // Validate the input for the dates, either a day of the given month or YYYY-MM-DD
+    string input;
 
     while (true) {
-        cout << setColor(instruct, 8);
+        cout << setColor(instruct, color);
         cin >> input;
 
-        if (!cin.fail() && input >= startValue && input <= endValue) {
-            break;
+        try {
+            Date date;
+            if (!input.empty() && input.find_first_not_of("0123456789") == string::npos) { // Only a day number was entered
+                date = Date(month.year, month.month, stoi(input));
+            }
+            else {
+                date.fromString(input);
+            }
+
+            if (date.toDayNumber() >= earliestDay) {
+                return date.toDayNumber();
+            }
+            cout << setColor("    Invalid input. Please enter a date from ", 12) << setColor(Date::fromDayNumber(earliestDay).toString(), 12) << setColor(" onwards.\n", 12);
         }
-        else {
+        catch (const exception&) {
             cin.clear(); // Clear the error flag
             cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Clear the input buffer
-            cout << setColor("Invalid input. Please enter a valid number between ", 12) << setColor(to_string(startValue), 12) << setColor(" and ", 12) << setColor(to_string(endValue), 12) << ".\n";
+            cout << setColor("    Invalid input. Please enter a day of ", 12) << setColor(Date::monthName(month.month) + " " + to_string(month.year), 12) << setColor(" or a date in YYYY-MM-DD format.\n", 12);
         }
     }
-    return input;
 }
 int validateInput(int startValue, int endValue, const string& instruct) { // Validate the input for the options such as dates
     int input;
@@ -61,7 +77,7 @@ string validateString(const string& instruct) { // Validate the input for the st
         getline(cin, input);
 
         if (input.empty()) {
-            cout << setColor("   You can not keep the title empty. Please enter a title.", 12) << endl;
+            cout << setColor("   You can not keep the title empty. Please enter a title.", 12) << "\n";
         }
         else {
             break;
@@ -75,8 +91,7 @@ bool validateOption(const  string& instruct) { // Validate the input for the men
     string option;
 
     cout << setColor(instruct, 15);
-    cin.ignore();
-    getline(cin, option);
+    getline(cin >> ws, option); // the title was read with getline, so only skip whitespace instead of a fixed character
 
     //if the first letter starts with y or Y then return true else false
     if (option[0] == 'y' || option[0] == 'Y') {
@@ -113,22 +128,123 @@ void validateTime(const string& instruct, int& hour, int& minute) { // Validate
     }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+
+    if (argc == 3 && (string(argv[1]) == "--import" || string(argv[1]) == "--bulk-import" || string(argv[1]) == "--export"
+        || string(argv[1]) == "--import-ics" || string(argv[1]) == "--export-ics")) { // Convert between the snapshot and the text or iCalendar format without opening the menu
+        Scheduler scheduler(numeric_limits<int>::min());
+        try {
+            if (string(argv[1]) == "--import") {
+                scheduler.loadEventsFrom_txt(argv[2]);
+                scheduler.compact(); // the import is not journaled, so write it straight into the snapshot
+            }
+            else if (string(argv[1]) == "--bulk-import" || string(argv[1]) == "--import-ics") {
+                vector<ImportConflict> conflicts;
+                if (string(argv[1]) == "--bulk-import") {
+                    ThreadPool pool;
+                    conflicts = scheduler.bulkImportFrom_txt(argv[2], pool);
+                }
+                else {
+                    conflicts = scheduler.importFrom_ics(argv[2]);
+                }
+                scheduler.compact();
+                for (const ImportConflict& conflict : conflicts) {
+                    cout << setColor("   Line " + to_string(conflict.line) + ": " + conflict.title + " on " + Date::fromDayNumber(conflict.date).toString() + " left out, " + conflict.reason + "\n", 12);
+                }
+                cout << setColor("   " + to_string(conflicts.size()) + (string(argv[1]) == "--bulk-import" ? " lines" : " events") + " left out.\n", conflicts.empty() ? 10 : 12);
+            }
+            else if (string(argv[1]) == "--export-ics") {
+                scheduler.saveEventsTo_ics(argv[2]);
+            }
+            else {
+                scheduler.saveEventsTo_txt(argv[2]);
+            }
+        }
+        catch (const exception& exception) {
+            cout << setColor("   Error: ", 12) << exception.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if ((argc == 2 || argc == 3) && string(argv[1]) == "--batch") { // --batch [file]: run the commands of the file, or of the standard input
+        ios::sync_with_stdio(false);
+        Scheduler scheduler(numeric_limits<int>::min());
+        CommandProcessor processor(scheduler);
+        if (argc == 3) {
+            ifstream commands(argv[2]);
+            if (!commands.is_open()) {
+                cout << setColor("   Error: ", 12) << SchedulerExceptions(5).what() << "\n";
+                return 1;
+            }
+            processor.run(commands, cout);
+        }
+        else {
+            processor.run(cin, cout);
+        }
+        return 0;
+    }
+
+    if (argc == 3 && string(argv[1]) == "--serve") { // --serve socket: keep the calendar in memory and answer batch commands over a Unix domain socket
+        Scheduler scheduler(numeric_limits<int>::min());
+        Daemon daemon(scheduler, argv[2]);
+        cout << setColor("   Serving the calendar on " + string(argv[2]) + ", stop with Ctrl+C.\n", 10) << flush;
+        if (!daemon.run()) {
+            cout << setColor("   Error: the socket could not be opened. It may be in use, or this system has no Unix domain sockets.\n", 12);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc >= 7 && string(argv[1]) == "--common-free") { // --common-free minutes YYYY-MM-DD YYYY-MM-DD HH:MM HH:MM calendar...
+        try {
+            Date firstDate, lastDate;
+            firstDate.fromString(argv[3]);
+            lastDate.fromString(argv[4]);
+            Time windowStart, windowEnd;
+            windowStart.fromString(argv[5]);
+            windowEnd.fromString(argv[6]);
+
+            ThreadPool pool;
+            CommonFreeTime search(pool);
+            for (int i = 7; i < argc; ++i) {
+                search.addCalendar(argv[i]);
+            }
+            vector<CandidateSlot> slots = search.findCommonSlots(stoi(argv[2]), firstDate.toDayNumber(), lastDate.toDayNumber(), windowStart, windowEnd, 10);
+            for (const CandidateSlot& slot : slots) {
+                cout << setColor("   " + Date::fromDayNumber(slot.date).toString() + " " + slot.startTime.toString() + " - " + slot.endTime.toString() + " (" + to_string(slot.gap) + " minutes free)\n", 10);
+            }
+            if (slots.empty()) {
+                cout << setColor("   No common free slot in the range.\n", 12);
+            }
+        }
+        catch (const exception& exception) {
+            cout << setColor("   Error: ", 12) << exception.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
-    int currentDay = validateInput_currentDay(1, 31, setColor("\nEnter the current day (1-31): ", 8)); // set the current day
+    int currentDay = validateDate(Date(2024, 7, 1), numeric_limits<int>::min(), "\nEnter the current date (1-31 for July 2024, or YYYY-MM-DD): ", 8); // set the current day
+    Date today = Date::fromDayNumber(currentDay);
+    string datePrompt = "      Enter date (" + to_string(today.day) + "-" + to_string(Date::daysInMonth(today.year, today.month)) + " or YYYY-MM-DD): ";
 
 
     Scheduler scheduler(currentDay);
 
     while (true) {
 
+        Status synced = scheduler.sync(); // make the last change durable before waiting for the user
+        if (!synced.isOk()) {
+            cout << setColor("   Error: ", 12) << setColor(synced.message(), 12) << "\n";
+        }
         scheduler.displayScheduler_print(currentDay);
 
-        int option = validateInput(1, 8, setColor("\n   Choose an option: ", 15));
+        int option = validateInput(1, 12, setColor("\n   Choose an option: ", 15));
 
-        if (option == 8) {
+        if (option == 12) {
             cout << setColor("You have exited the program.\n", 12);
-            cout << setColor("", 8) << endl;
+            cout << setColor("", 8) << "\n";
             break;
         }
 
@@ -138,7 +254,7 @@ int main() {
 
             int startHour, startMinute, endHour, endMinute;
 
-            int date = validateInput(currentDay, 31, "      Enter date (" + to_string(currentDay) + "-31): ");
+            int date = validateDate(today, currentDay, datePrompt);
             string title = validateString("      Enter event title: ");
             validateTime("      Enter start time (HH:MM): ", startHour, startMinute);
             validateTime("      Enter end time (HH:MM): ", endHour, endMinute);
@@ -148,17 +264,17 @@ int main() {
             try {
                 Time start(startHour, startMinute);
                 Time end(endHour, endMinute);
-                Event event(title, start, end, repeatType);
+                Event event(title, start, end, repeatTypeFromString(repeatType));
                 scheduler.scheduleEvent(date, event);
             }
             catch (const exception& exception) {
-                cout << setColor("   Error: ", 12) << exception.what() << endl;
+                cout << setColor("   Error: ", 12) << exception.what() << "\n";
             }
             break;
         }
         case 2: { // Cancel event
 
-            int date = validateInput(currentDay, 31, "      Enter date (1-31): ");
+            int date = validateDate(today, currentDay, datePrompt);
             string title = validateString("      Enter event title: ");
 
             if (scheduler.isEventRepeating(date, title)) { // Check if the event is repeating
@@ -172,49 +288,90 @@ int main() {
         }
         case 3: { // Shift event
 
-            int date = validateInput(currentDay, 31, "      Enter date (" + to_string(currentDay) + "-31): ");
+            int date = validateDate(today, currentDay, datePrompt);
             string title = validateString("      Enter event title: ");
-            int newDate = validateInput(currentDay, 31, "      Enter new date (" + to_string(currentDay) + "-31): ");
+            int newDate = validateDate(today, currentDay, "      Enter new date (" + to_string(today.day) + "-" + to_string(Date::daysInMonth(today.year, today.month)) + " or YYYY-MM-DD): ");
 
             scheduler.shiftEvent(date, title, newDate);
             break;
         }
         case 4: {
 
-            int date = validateInput(currentDay, 31, "      Enter date (" + to_string(currentDay) + "-31): ");
+            int date = validateDate(today, currentDay, datePrompt);
 
             scheduler.setDayOff(date);
             break;
         }
         case 5: { //  View day schedule
 
-            int date = validateInput(currentDay, 31, "      Enter date (" + to_string(currentDay) + "-31): ");
+            int date = validateDate(today, currentDay, datePrompt);
 
             try {
                 scheduler.viewDaySchedule(date);
 
             }
             catch (const exception& exception) {
-                cout << setColor("   Error: ", 12) << exception.what() << endl;
+                cout << setColor("   Error: ", 12) << exception.what() << "\n";
             }
             break;
         }
 
         case 6: { // View week schedule
 
-            int startDate = validateInput(currentDay, 31, "      Enter date (" + to_string(currentDay) + "-31): ");
+            int startDate = validateDate(today, currentDay, datePrompt);
 
             try {
                 scheduler.viewWeekSchedule(startDate);
             }
             catch (const exception& exception) {
-                cout << setColor("   Error: ", 12) << exception.what() << endl;
+                cout << setColor("   Error: ", 12) << exception.what() << "\n";
             }
             break;
         }
         case 7: { // View month schedule
 
-            scheduler.displayScheduler();
+            int date = validateDate(today, numeric_limits<int>::min(), "      Enter a date in the month (day or YYYY-MM-DD): ");
+
+            try {
+                scheduler.displayScheduler(date);
+            }
+            catch (const exception& exception) {
+                cout << setColor("   Error: ", 12) << exception.what() << "\n";
+            }
+            break;
+        }
+        case 8: { // Find a free slot
+
+            int startHour, startMinute, endHour, endMinute;
+
+            int duration = validateInput(1, 1439, "      Enter the length in minutes: ");
+            int firstDate = validateDate(today, currentDay, "      Search from date (" + to_string(today.day) + "-" + to_string(Date::daysInMonth(today.year, today.month)) + " or YYYY-MM-DD): ");
+            int lastDate = validateDate(today, firstDate, "      Search until date (day or YYYY-MM-DD): ");
+            validateTime("      Not before (HH:MM): ", startHour, startMinute);
+            validateTime("      Not after (HH:MM): ", endHour, endMinute);
+
+            FreeSlot slot = scheduler.findFreeSlot(duration, firstDate, lastDate, Time(startHour, startMinute), Time(endHour, endMinute));
+            if (slot.found) {
+                cout << setColor("   Free on " + Date::fromDayNumber(slot.date).toLongString() + " from " + slot.startTime.toString() + " to " + slot.endTime.toString() + ".\n", 10);
+            }
+            else {
+                cout << setColor("   No free slot of that length in the range.\n", 12);
+            }
+            break;
+        }
+        case 9: { // View statistics
+
+            scheduler.viewStatistics();
+            break;
+        }
+        case 10: { // Undo the last change
+
+            scheduler.undoChange();
+            break;
+        }
+        case 11: { // Redo a change that was undone
+
+            scheduler.redoChange();
             break;
         }
 
@@ -0,0 +1,87 @@
+#include "OccupancyBitmap.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+static int countTrailingZeros(uint64_t word) { // word must not be zero
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int)index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+static uint64_t bitsFrom(int bit) { // the bits at and above the position within a word
+    return ~0ULL << bit;
+}
+
+OccupancyBitmap::OccupancyBitmap() {
+    clear();
+}
+
+void OccupancyBitmap::setRange(int startMinute, int endMinute) {
+    for (int word = startMinute / 64; word * 64 < endMinute; ++word) { // whole words are filled at once, only the two ends are masked
+        uint64_t mask = ~0ULL;
+        if (word == startMinute / 64) mask &= bitsFrom(startMinute % 64);
+        if (word == endMinute / 64) mask &= ~bitsFrom(endMinute % 64);
+        words[word] |= mask;
+    }
+}
+
+void OccupancyBitmap::clearRange(int startMinute, int endMinute) {
+    for (int word = startMinute / 64; word * 64 < endMinute; ++word) {
+        uint64_t mask = ~0ULL;
+        if (word == startMinute / 64) mask &= bitsFrom(startMinute % 64);
+        if (word == endMinute / 64) mask &= ~bitsFrom(endMinute % 64);
+        words[word] &= ~mask;
+    }
+}
+
+void OccupancyBitmap::clear() {
+    for (int word = 0; word < WORD_COUNT; ++word) {
+        words[word] = 0;
+    }
+}
+
+void OccupancyBitmap::merge(const OccupancyBitmap& other) {
+    for (int word = 0; word < WORD_COUNT; ++word) {
+        words[word] |= other.words[word];
+    }
+}
+
+bool OccupancyBitmap::isFree(int startMinute, int endMinute) const {
+    return nextWithValue(startMinute, endMinute, true) == endMinute;
+}
+
+int OccupancyBitmap::nextWithValue(int from, int limit, bool busy) const {
+    if (from >= limit) {
+        return limit;
+    }
+    int word = from / 64;
+    uint64_t bits = (busy ? words[word] : ~words[word]) & bitsFrom(from % 64);
+    while (bits == 0) { // skip 64 minutes at a time
+        if (++word * 64 >= limit) {
+            return limit;
+        }
+        bits = busy ? words[word] : ~words[word];
+    }
+    int minute = word * 64 + countTrailingZeros(bits);
+    return minute < limit ? minute : limit;
+}
+
+int OccupancyBitmap::findFreeRun(int duration, int windowStart, int windowEnd) const {
+    int start = nextWithValue(windowStart, windowEnd, false);
+    while (start + duration <= windowEnd) { // jump from the start of a free run to its end and on to the next free run
+        int end = nextWithValue(start, windowEnd, true);
+        if (end - start >= duration) {
+            return start;
+        }
+        start = nextWithValue(end, windowEnd, false);
+    }
+    return -1;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+using namespace std;
+
+class OccupancyBitmap { // One bit per minute of a day, set while an event is running
+public:
+    static const int MINUTES_PER_DAY = 1440;
+    static const int WORD_COUNT = (MINUTES_PER_DAY + 63) / 64;
+
+private:
+    uint64_t words[WORD_COUNT]; // minute m is bit m % 64 of word m / 64, the bits after the last minute stay clear
+
+    int nextWithValue(int from, int limit, bool busy) const; // first minute in [from, limit) that is busy (or free), or limit
+
+public:
+    OccupancyBitmap();
+
+    void setRange(int startMinute, int endMinute); // mark [startMinute, endMinute) as busy
+    void clearRange(int startMinute, int endMinute);
+    void clear();
+    void merge(const OccupancyBitmap& other); // busy wherever either bitmap is busy
+
+    bool isFree(int startMinute, int endMinute) const;
+    int nextBusy(int from, int limit) const { return nextWithValue(from, limit, true); } // first busy minute in [from, limit), or limit
+
+    // Earliest start of duration free minutes that lies inside [windowStart, windowEnd), or -1
+    int findFreeRun(int duration, int windowStart, int windowEnd) const;
+};
@@ -0,0 +1,37 @@
+#include "ParseExceptions.h"
+
+#include <string>
+
+using namespace std;
+
+ParseExceptions::ParseExceptions(int code, int line, int column) : Exceptions(code) { // Constructor for the ParseExceptions class
+    this->line = line;
+    this->column = column;
+
+    switch (errorCode) {
+    case 1:
+        errorMessage = "Invalid date, expected YYYY-MM-DD";
+        break;
+    case 2:
+        errorMessage = "Invalid time, expected HH:MM";
+        break;
+    case 3:
+        errorMessage = "Missing field";
+        break;
+    case 4:
+        errorMessage = "The title is empty";
+        break;
+    case 5:
+        errorMessage = "Event end time must be after start time";
+        break;
+    case 6:
+        errorMessage = "Unknown command";
+        break;
+    case 7:
+        errorMessage = "Invalid number";
+        break;
+    default:
+        errorMessage = "Parse error";
+    }
+    errorMessage = "Line " + to_string(line) + ", column " + to_string(column) + ": " + errorMessage;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Exceptions.h"
+
+class ParseExceptions : public Exceptions { // Derived class for the errors found while reading the event text format
+private:
+	int line;
+	int column;
+
+public:
+	ParseExceptions(int code, int line, int column); // line and column start at 1
+
+	int getCode() const { return errorCode; }
+	int getLine() const { return line; }
+	int getColumn() const { return column; }
+};
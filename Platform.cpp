@@ -0,0 +1,235 @@
+#include "Platform.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004 // missing from SDKs older than Windows 10
+#endif
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+MappedFile::MappedFile() {
+    this->data = nullptr;
+    this->length = 0;
+#ifdef _WIN32
+    this->fileHandle = INVALID_HANDLE_VALUE;
+    this->mappingHandle = nullptr;
+#else
+    this->fileDescriptor = -1;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const string& path) {
+    close();
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        close();
+        return false;
+    }
+    if (fileSize.QuadPart == 0) { // an empty file cannot be mapped, it is opened with no data
+        close();
+        return true;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        close();
+        return false;
+    }
+    data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    length = (size_t)fileSize.QuadPart;
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0) {
+        close();
+        return false;
+    }
+    if (fileStatus.st_size == 0) { // an empty file cannot be mapped, it is opened with no data
+        close();
+        return true;
+    }
+    void* mapping = mmap(nullptr, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    data = (mapping == MAP_FAILED) ? nullptr : static_cast<const char*>(mapping);
+    length = (size_t)fileStatus.st_size;
+#endif
+    if (data == nullptr) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (data != nullptr) UnmapViewOfFile(data);
+    if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (data != nullptr) munmap(const_cast<char*>(data), length);
+    if (fileDescriptor >= 0) ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+    data = nullptr;
+    length = 0;
+}
+
+AppendFile::AppendFile() {
+    this->fileDescriptor = -1;
+}
+
+AppendFile::~AppendFile() {
+    close();
+}
+
+bool AppendFile::open(const string& path) {
+    close();
+#ifdef _WIN32
+    _sopen_s(&fileDescriptor, path.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _SH_DENYWR, _S_IREAD | _S_IWRITE);
+#else
+    fileDescriptor = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+#endif
+    return fileDescriptor >= 0;
+}
+
+void AppendFile::close() {
+    if (fileDescriptor >= 0) {
+#ifdef _WIN32
+        _close(fileDescriptor);
+#else
+        ::close(fileDescriptor);
+#endif
+    }
+    fileDescriptor = -1;
+}
+
+bool AppendFile::write(const char* data, size_t size) {
+    while (size > 0) { // a write may take only part of the data
+#ifdef _WIN32
+        int written = _write(fileDescriptor, data, (unsigned int)size);
+#else
+        ssize_t written = ::write(fileDescriptor, data, size);
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+bool AppendFile::flushToDisk() {
+#ifdef _WIN32
+    return _commit(fileDescriptor) == 0;
+#else
+    return fsync(fileDescriptor) == 0;
+#endif
+}
+
+bool AppendFile::truncate(size_t size) {
+#ifdef _WIN32
+    return _chsize_s(fileDescriptor, (long long)size) == 0;
+#else
+    return ftruncate(fileDescriptor, (off_t)size) == 0;
+#endif
+}
+
+bool writeFileDurably(const string& path, const string& contents) {
+    AppendFile file;
+    return file.open(path) && file.truncate() && file.write(contents.data(), contents.size()) && file.flushToDisk();
+}
+
+bool writeFileHeadDurably(const string& path, const char* data, size_t size) {
+#ifdef _WIN32
+    int fileDescriptor = -1;
+    _sopen_s(&fileDescriptor, path.c_str(), _O_WRONLY | _O_BINARY, _SH_DENYWR, _S_IREAD | _S_IWRITE);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    bool written = _write(fileDescriptor, data, (unsigned int)size) == (int)size && _commit(fileDescriptor) == 0;
+    _close(fileDescriptor);
+#else
+    int fileDescriptor = ::open(path.c_str(), O_WRONLY); // without O_APPEND the write lands at offset 0
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    bool written = ::write(fileDescriptor, data, size) == (ssize_t)size && fsync(fileDescriptor) == 0;
+    ::close(fileDescriptor);
+#endif
+    return written;
+}
+
+bool fileExists(const string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    fclose(file);
+    return true;
+}
+
+bool replaceFile(const string& source, const string& target) {
+#ifdef _WIN32
+    return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(source.c_str(), target.c_str()) == 0;
+#endif
+}
+
+bool enableTerminalColors() {
+#ifdef _WIN32
+    if (!_isatty(_fileno(stdout))) {
+        return false;
+    }
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    return GetConsoleMode(console, &mode) && SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#else
+    const char* terminal = getenv("TERM");
+    return isatty(STDOUT_FILENO) && (terminal == nullptr || string(terminal) != "dumb");
+#endif
+}
+
+bool writeStandardOutput(const string& text) {
+    const char* data = text.data();
+    size_t size = text.size();
+    while (size > 0) { // a terminal may take only part of a large frame
+#ifdef _WIN32
+        int written = _write(_fileno(stdout), data, (unsigned int)size);
+#else
+        ssize_t written = ::write(STDOUT_FILENO, data, size);
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+class MappedFile { // Read-only memory mapping of a whole file, closed when the object goes out of scope
+private:
+    const char* data;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& path); // returns false if the file does not exist or cannot be mapped, an empty file has no data
+    void close();
+    const char* begin() const { return data; }
+    size_t size() const { return length; }
+};
+
+class AppendFile { // File opened for appending, with an explicit flush down to the disk
+private:
+    int fileDescriptor;
+
+public:
+    AppendFile();
+    ~AppendFile();
+    AppendFile(const AppendFile&) = delete;
+    AppendFile& operator=(const AppendFile&) = delete;
+
+    bool open(const string& path); // creates the file if it does not exist
+    void close();
+    bool isOpen() const { return fileDescriptor >= 0; }
+    bool write(const char* data, size_t size);
+    bool flushToDisk(); // fsync, or _commit on Windows
+    bool truncate(size_t size = 0); // cut the file down to the size, dropping everything by default
+};
+
+bool fileExists(const string& path);
+
+bool writeFileDurably(const string& path, const string& contents); // write the whole file in one go and flush it to the disk
+
+bool writeFileHeadDurably(const string& path, const char* data, size_t size); // overwrite the start of an existing file in place and flush it to the disk
+
+bool replaceFile(const string& source, const string& target); // rename the source over the target in one step
+
+bool enableTerminalColors(); // true if the standard output is a terminal that shows ANSI colors, switched on first for Windows consoles
+
+bool writeStandardOutput(const string& text); // write straight to the standard output in as few calls as the system allows
@@ -0,0 +1,63 @@
+#include "RecurrenceRule.h"
+#include "Date.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+RecurrenceRule::RecurrenceRule(int id, Event event, int firstDay, int lastDay) {
+    this->id = id;
+    this->event = event;
+    this->firstDay = firstDay;
+    this->lastDay = lastDay;
+    this->period = defaultPeriod(event.repeatType);
+}
+
+int RecurrenceRule::defaultPeriod(RepeatType repeatType) {
+    return (repeatType == RepeatType::Daily) ? 1 : 7;
+}
+
+bool RecurrenceRule::matchesPattern(int date) const {
+    return date >= firstDay && date <= lastDay && (date - firstDay) % period == 0;
+}
+
+bool RecurrenceRule::occursOn(int date) const {
+    return matchesPattern(date) && exceptions.count(date) == 0;
+}
+
+void RecurrenceRule::cancelFrom(int date) {
+    lastDay = date - 1;
+}
+
+string RecurrenceRule::formatRuleDataToString() const { // format the rule as an event line followed by its limits
+    string ruleString;
+    appendRuleData(ruleString);
+    return ruleString;
+}
+
+void RecurrenceRule::appendRuleData(string& output) const {
+    char dateString[Date::MAX_TEXT_LENGTH];
+    output.append(dateString, Date::fromDayNumber(firstDay).writeTo(dateString));
+    output += '|';
+    event.appendEventData(output);
+    output += '|';
+    if (lastDay != NO_END) {
+        output.append(dateString, Date::fromDayNumber(lastDay).writeTo(dateString));
+    }
+    output += '|';
+
+    vector<int> sortedExceptions(exceptions.begin(), exceptions.end());
+    sort(sortedExceptions.begin(), sortedExceptions.end());
+    for (size_t i = 0; i < sortedExceptions.size(); ++i) {
+        if (i > 0) {
+            output += ',';
+        }
+        output.append(dateString, Date::fromDayNumber(sortedExceptions[i]).writeTo(dateString));
+    }
+    if (period != defaultPeriod(event.repeatType)) {
+        output += '|';
+        output += to_string(period);
+    }
+    output += '\n';
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <climits>
+#include <string>
+#include <unordered_set>
+#include "Event.h"
+
+using namespace std;
+
+class RecurrenceRule { // Class for a repeating event, stored once and expanded only for the days that are looked at
+public:
+    static const int NO_END = INT_MAX; // lastDay of a series that repeats forever
+
+    int id;
+    Event event; // title, time window and repeat type shared by every occurrence
+    int firstDay; // day number of the first occurrence
+    int lastDay; // no occurrence falls after this day number
+    int period; // days between two occurrences
+    unordered_set<int> exceptions; // day numbers of cancelled occurrences
+
+    RecurrenceRule(int id = 0, Event event = Event(), int firstDay = 0, int lastDay = NO_END);
+
+    static int defaultPeriod(RepeatType repeatType); // one day or one week
+
+    bool matchesPattern(int date) const; // the date lies on the series, cancelled or not
+    bool occursOn(int date) const;
+    void cancelFrom(int date); // end the series before the date
+
+    string formatRuleDataToString() const; // the series is read back by TextParser
+    void appendRuleData(string& output) const; // the line of formatRuleDataToString() at the end of the output
+};
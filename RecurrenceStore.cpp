@@ -0,0 +1,149 @@
+#include "RecurrenceStore.h"
+
+#include <algorithm>
+
+using namespace std;
+
+RecurrenceStore::RecurrenceStore() {
+    this->table = make_shared<RuleTable>();
+    this->changeCount = 0;
+    this->tableShared = false;
+    this->recording = nullptr;
+}
+
+RecurrenceStore::RuleTable& RecurrenceStore::writable() {
+    if (tableShared || table.use_count() > 1) { // readers never hold a table that was not published, so the count only moves on this thread
+        table = make_shared<RuleTable>(*table);
+        table->ownIds.clear(); // the copy holds the same series
+        tableShared = false;
+    }
+    ++changeCount;
+    return *table;
+}
+
+void RecurrenceStore::keep(int id) {
+    if (recording != nullptr && recording->previous.count(id) == 0) {
+        auto it = table->rules.find(id);
+        recording->previous.emplace(id, it != table->rules.end() ? optional<RecurrenceRule>(*it->second) : nullopt);
+    }
+}
+
+void RecurrenceStore::link(RuleTable& rules, const RecurrenceRule& rule) {
+    vector<int>& ids = rules.idsByTitle[rule.event.title.getId()];
+    ids.insert(lower_bound(ids.begin(), ids.end(), rule.id), rule.id); // new ids go to the end, a series put back by revert() may not
+    rules.rules.emplace(rule.id, make_shared<RecurrenceRule>(rule));
+    rules.ownIds.insert(rule.id);
+}
+
+void RecurrenceStore::unlink(RuleTable& rules, int id) {
+    auto it = rules.rules.find(id);
+    auto titleIt = rules.idsByTitle.find(it->second->event.title.getId());
+    vector<int>& ids = titleIt->second;
+    ids.erase(std::find(ids.begin(), ids.end(), id));
+    if (ids.empty()) {
+        rules.idsByTitle.erase(titleIt);
+    }
+    rules.rules.erase(it);
+    rules.ownIds.erase(id);
+}
+
+RecurrenceRule& RecurrenceStore::add(RecurrenceRule rule) {
+    RuleTable& rules = writable();
+    rule.id = rules.nextId++;
+    keep(rule.id);
+    link(rules, rule);
+    return *rules.rules.at(rule.id);
+}
+
+void RecurrenceStore::remove(int id) {
+    if (table->rules.count(id) == 0) {
+        return;
+    }
+    keep(id);
+    unlink(writable(), id);
+}
+
+const RecurrenceRule* RecurrenceStore::find(int id) const {
+    auto it = table->rules.find(id);
+    return it == table->rules.end() ? nullptr : it->second.get();
+}
+
+RecurrenceRule* RecurrenceStore::writableRule(int id) {
+    if (table->rules.count(id) == 0) {
+        return nullptr; // looking for a series that does not exist does not clone anything
+    }
+    keep(id);
+    RuleTable& rules = writable();
+    shared_ptr<RecurrenceRule>& rule = rules.rules.at(id);
+    if (rules.ownIds.insert(id).second) { // a copy or a reader may still hold the series
+        rule = make_shared<RecurrenceRule>(*rule);
+    }
+    return rule.get();
+}
+
+const vector<int>* RecurrenceStore::idsWithTitle(Title title) const {
+    auto it = table->idsByTitle.find(title.getId());
+    return it == table->idsByTitle.end() ? nullptr : &it->second;
+}
+
+const RecurrenceRule* RecurrenceStore::findOccurrence(int date, Title title) const {
+    const vector<int>* ids = idsWithTitle(title);
+    if (ids == nullptr) {
+        return nullptr;
+    }
+    for (int id : *ids) {
+        const RecurrenceRule& rule = *table->rules.at(id);
+        if (rule.occursOn(date)) {
+            return &rule;
+        }
+    }
+    return nullptr;
+}
+
+int RecurrenceStore::size() const {
+    return (int)table->rules.size();
+}
+
+void RecurrenceStore::markPublished() {
+    tableShared = true;
+}
+
+void RecurrenceStore::record(Change* change) {
+    if (change != nullptr) {
+        change->nextId = table->nextId;
+    }
+    recording = change;
+}
+
+void RecurrenceStore::revert(Change& change) {
+    RuleTable& rules = writable(); // also moves the version on, so the series are saved with the next snapshot
+    for (auto it = change.previous.begin(); it != change.previous.end(); ++it) {
+        auto current = rules.rules.find(it->first);
+        optional<RecurrenceRule> replaced = (current != rules.rules.end()) ? optional<RecurrenceRule>(*current->second) : nullopt;
+        if (replaced.has_value()) {
+            unlink(rules, it->first);
+        }
+        if (it->second.has_value()) {
+            link(rules, *it->second);
+        }
+        it->second = move(replaced);
+    }
+    swap(rules.nextId, change.nextId);
+}
+
+void RecurrenceStore::restore(const RecurrenceStore& version, Change& change) { // The series are few, so a copy that differs records all of them
+    change.previous.clear();
+    change.nextId = table->nextId;
+    if (table == version.table) {
+        return;
+    }
+    for (auto it = table->rules.begin(); it != table->rules.end(); ++it) {
+        change.previous.emplace(it->first, *it->second);
+    }
+    for (auto it = version.table->rules.begin(); it != version.table->rules.end(); ++it) {
+        change.previous.emplace(it->first, nullopt); // emplace keeps a series that is in both
+    }
+    table = version.table;
+    tableShared = true;
+    ++changeCount;
+}
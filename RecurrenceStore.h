@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "RecurrenceRule.h"
+
+using namespace std;
+
+/*
+ * Store of the repeating series, each kept once as a rule.
+ *
+ * The rules sit in one table behind a shared_ptr and each rule behind a shared_ptr of its own, as DayStore does for
+ * its segments, so copying the store is cheap and the copy keeps seeing the rules as they were: the first write
+ * while a copy still uses them clones the table of pointers and the one rule that changes, not every rule and its
+ * cancelled dates. As in DayStore, sharing is not read from use_count(): after markPublished() the first write clones
+ * the table, and only the series added or cloned since then are written in place.
+ * While a Change is recorded, every series that is handed out for writing, added or removed is first copied into it
+ * as it was, as DayStore does for its days. Lookups are read only and leave the table and its version alone.
+ */
+class RecurrenceStore {
+public:
+    struct Change { // the series a change touched, as they were before it
+        map<int, optional<RecurrenceRule>> previous; // keyed by rule id, nullopt for a series that the change added
+        int nextId;
+    };
+
+private:
+    struct RuleTable {
+        map<int, shared_ptr<RecurrenceRule>> rules; // keyed by rule id, which follows the order the series were created in
+        unordered_map<uint32_t, vector<int>> idsByTitle; // ids of the series with each title, in id order, so lookups by title skip the other series
+        int nextId = 1;
+        unordered_set<int> ownIds; // series added or cloned since the table was cloned, held by no other table
+    };
+    shared_ptr<RuleTable> table;
+    uint64_t changeCount; // write accesses to the table, see version()
+    bool tableShared; // published or restored since the table was cloned, so other threads may hold it
+    Change* recording; // nullptr unless a change is being recorded
+
+    RuleTable& writable(); // clones the table of pointers if a copy of the store still uses it, and counts the access
+    void keep(int id); // copy the series into the recorded change before its first write access
+    static void link(RuleTable& rules, const RecurrenceRule& rule); // put the series in the table and its title index
+    static void unlink(RuleTable& rules, int id);
+    const vector<int>* idsWithTitle(Title title) const; // nullptr if no series has the title
+
+public:
+    RecurrenceStore();
+
+    RecurrenceRule& add(RecurrenceRule rule); // assigns the id of the rule
+    void remove(int id);
+    const RecurrenceRule* find(int id) const; // nullptr if there is no such series
+    RecurrenceRule* writableRule(int id); // the series for a change, moves the version on; take it only once the change is accepted
+    const RecurrenceRule* findOccurrence(int date, Title title) const; // the series with the title that occurs on the date
+    int size() const;
+    uint64_t version() const { return changeCount; } // unchanged as long as no rule was handed out for writing
+    void markPublished(); // a copy was handed to readers, the next write clones the table and every series it touches
+
+    void record(Change* change); // keep the series as they were before each first write access in the change, nullptr stops
+    void revert(Change& change); // put the recorded series back, the change then holds the ones it replaced
+    void restore(const RecurrenceStore& version, Change& change); // go back to a copy of the store, recording every series if the copy differs
+
+    template <typename Function>
+    void forEachWithTitle(Title title, Function function) const { // visit the series with the title in id order
+        const vector<int>* ids = idsWithTitle(title);
+        if (ids == nullptr) {
+            return;
+        }
+        for (int id : *ids) {
+            function(*table->rules.at(id));
+        }
+    }
+
+    template <typename Function>
+    void forEachOccurringOn(int date, Function function) const { // visit the series that have an occurrence on the date
+        for (auto it = table->rules.begin(); it != table->rules.end(); ++it) {
+            if (it->second->occursOn(date)) {
+                function(*it->second);
+            }
+        }
+    }
+
+    template <typename Function>
+    void forEach(Function function) const {
+        for (auto it = table->rules.begin(); it != table->rules.end(); ++it) {
+            function(*it->second);
+        }
+    }
+};
@@ -0,0 +1,70 @@
+#include "RenderCache.h"
+
+using namespace std;
+
+RenderCache::RenderCache() {
+    this->lookedUp = { RenderView::Week, 0 };
+    this->lookedUpRulesVersion = 0;
+    this->storedViews = 0;
+}
+
+const string& RenderCache::dayText(const CalendarState& state, int date) {
+    const Day* storedDay = state.days.find(date);
+    uint64_t dayVersion = (storedDay != nullptr) ? storedDay->version : 0;
+    uint64_t rulesVersion = state.rules.version();
+
+    auto it = days.find(date);
+    if (it == days.end()) {
+        if (days.size() >= MAX_DAYS) {
+            days.clear();
+        }
+        it = days.emplace(date, DayEntry{ 0, 0, string() }).first;
+    }
+    else if (it->second.dayVersion == dayVersion && it->second.rulesVersion == rulesVersion) {
+        return it->second.text;
+    }
+
+    DayEntry& entry = it->second;
+    entry.dayVersion = dayVersion;
+    entry.rulesVersion = rulesVersion;
+    entry.text.clear(); // the buffer keeps its capacity for the next time the day changes
+    if (state.rules.size() == 0) { // without series the stored day is what is shown
+        if (storedDay != nullptr) {
+            storedDay->appendText(entry.text);
+        }
+    }
+    else {
+        state.expandDay(date).appendText(entry.text);
+    }
+    return entry.text;
+}
+
+const string* RenderCache::findView(RenderView view, int key, const CalendarState& state, int firstDay, int lastDay, bool showsSeries) {
+    lookedUp = { view, key };
+    lookedUpRulesVersion = showsSeries ? state.rules.version() : 0;
+    lookedUpDays.clear();
+    state.days.forEachInRange(firstDay, lastDay, [this](const Day& day) {
+        lookedUpDays.push_back((uint64_t)(uint32_t)day.date);
+        lookedUpDays.push_back(day.version);
+    });
+
+    auto it = views.find(lookedUp);
+    if (it == views.end() || it->second.rulesVersion != lookedUpRulesVersion || it->second.days != lookedUpDays) {
+        return nullptr;
+    }
+    return &it->second.text;
+}
+
+void RenderCache::storeView(const string& text) {
+    auto it = views.find(lookedUp);
+    if (it == views.end()) {
+        if (views.size() >= MAX_VIEWS) {
+            views.clear();
+        }
+        it = views.emplace(lookedUp, ViewEntry()).first;
+    }
+    it->second.days.swap(lookedUpDays);
+    it->second.rulesVersion = lookedUpRulesVersion;
+    it->second.text = text;
+    ++storedViews;
+}
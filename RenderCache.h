@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "CalendarState.h"
+
+using namespace std;
+
+enum class RenderView : uint8_t { Week, Month, MonthGrid };
+
+/*
+ * The text of the days and of the views as they were drawn last.
+ *
+ * Every write access to a day stamps it with a new version and every write access to the series moves their version
+ * (see DayStore and RecurrenceStore), so a day's text stays valid as long as neither version has moved. A view keeps
+ * the dates and versions of the stored days it shows and is copied out whole while they are the same; otherwise it
+ * is built again from the days' texts, which formats only the days that changed.
+ *
+ * A lookup or a change that is turned down moves neither version, so it leaves every text valid.
+ *
+ * The cache is not synchronized, the Scheduler draws one view at a time.
+ */
+class RenderCache {
+private:
+    static const size_t MAX_DAYS = 4096; // the cache is emptied when it would hold more
+    static const size_t MAX_VIEWS = 64;
+
+    struct DayEntry {
+        uint64_t dayVersion; // 0 if the day was not stored
+        uint64_t rulesVersion;
+        string text;
+    };
+
+    struct ViewEntry {
+        vector<uint64_t> days; // date and version of each stored day of the view
+        uint64_t rulesVersion; // 0 for a view that does not show the series
+        string text;
+    };
+
+    unordered_map<int, DayEntry> days;
+    map<pair<RenderView, int>, ViewEntry> views;
+    pair<RenderView, int> lookedUp; // the view of the last findView(), stored by storeView()
+    vector<uint64_t> lookedUpDays;
+    uint64_t lookedUpRulesVersion;
+    uint64_t storedViews;
+
+public:
+    RenderCache();
+
+    const string& dayText(const CalendarState& state, int date); // Day::toString() of the day with its series, formatted again only if either changed
+
+    // The text of the view, or nullptr if it was not stored or a day it shows has changed since.
+    // key tells the views of one kind apart, such as the first day of a week.
+    const string* findView(RenderView view, int key, const CalendarState& state, int firstDay, int lastDay, bool showsSeries);
+    void storeView(const string& text); // the text of the view looked for last
+    uint64_t builtViews() const { return storedViews; } // views that were built rather than copied out, since the cache was made
+};
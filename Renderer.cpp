@@ -0,0 +1,64 @@
+#include "Renderer.h"
+#include "Platform.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+bool Renderer::colorEnabled() {
+    static const bool enabled = getenv("NO_COLOR") == nullptr && enableTerminalColors();
+    return enabled;
+}
+
+string Renderer::colorize(const string& text, int color) {
+    if (!colorEnabled()) {
+        return text;
+    }
+
+    const char* escape;
+    switch (color) {
+    case 9:
+        escape = "\x1b[94m"; // Light Blue
+        break;
+    case 10:
+        escape = "\x1b[92m"; // Light Green
+        break;
+    case 11:
+        escape = "\x1b[96m"; // Light Aqua
+        break;
+    case 12:
+        escape = "\x1b[91m"; // Light Red
+        break;
+    case 13:
+        escape = "\x1b[95m"; // Light Purple
+        break;
+    case 14:
+        escape = "\x1b[93m"; // Light Yellow
+        break;
+    case 15:
+        escape = "\x1b[97m"; // Light White
+        break;
+    case 16:
+        escape = "\x1b[30;106m"; // Black on Light Aqua
+        break;
+    default:
+        escape = "\x1b[90m"; // Light Ash
+        break;
+    }
+    return escape + text + "\x1b[0m";
+}
+
+void Renderer::append(const string& text, int color) {
+    frame += colorize(text, color);
+}
+
+void Renderer::present() {
+    cout.flush(); // keep the order of the messages that were written before the frame
+    writeStandardOutput(frame);
+    frame.clear();
+}
+
+string setColor(const string& txt, const int& color) {
+    return Renderer::colorize(txt, color);
+}
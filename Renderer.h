@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+/*
+ * Builds a whole screen in one buffer and writes it with a single call.
+ *
+ * Colors are the console color numbers the program has always used (8 ash, 9 blue, 10 green, 11 aqua, 12 red,
+ * 13 purple, 14 yellow, 15 white, 16 black on aqua for today) and are written as ANSI escapes. They are left
+ * out when the output is not a terminal or NO_COLOR is set, so piped output stays plain text.
+ */
+class Renderer {
+private:
+    string frame;
+
+public:
+    static bool colorEnabled(); // decided once, on the first call
+    static string colorize(const string& text, int color);
+
+    void append(const string& text) { frame += text; }
+    void append(const string& text, int color);
+    const string& text() const { return frame; } // the frame composed so far, colors included
+    void present(); // write the frame after anything still waiting in cout, then start an empty frame
+};
+
+string setColor(const string& txt, const int& color); // the text wrapped in the escapes of the color, see Renderer
@@ -2,104 +2,752 @@
 
 #include "SchedulerExceptions.h"
 #include "DayExceptions.h"
+#include "Date.h"
 #include "Event.h"
 #include "Day.h"
+#include "RecurrenceRule.h"
+#include "ConflictChecker.h"
+#include "Snapshot.h"
+#include "Platform.h"
+#include "TextParser.h"
+#include "BulkImporter.h"
+#include "IcsReader.h"
+#include "IcsWriter.h"
+#include "Renderer.h"
+#include "Stats.h"
 
-
-#include <windows.h> // to access colors in the command instruct 
-#undef max          // max() function is defined in both limits and windows.h and limits, therefore to avoid clash between definitions max function 
-                    // defined in windows.h is removed
-
+#include <cstdio>
 #include <iostream>
 #include <fstream>
-#include <sstream> // Stringstream function is used to convert the strings to stream which will be usefull throughout the code. 
 #include <limits> // for the numeric_limits of the streamsize in the ignore function
 #include <string>
-
-#include <iomanip> //just 1 function used in displayCalendar_print function setw(2)
+#include <unordered_set>
+#include <vector>
 
 using namespace std;
 
-HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE); // this global object of HANDLE class from windows.h header file to allow command instruct colors
+const string DEFAULT_DATA_PATH = "EventFile";
+static const size_t TEXT_BUFFER_SIZE = 1 << 16; // the text export is written in blocks of about this size
+
+int Scheduler::lastDayOfMonth(int date) const {
+    Date day = Date::fromDayNumber(date);
+    return date + Date::daysInMonth(day.year, day.month) - day.day;
+}
 
-void Scheduler::initializeDays() {
-    string daysOfWeek[] = { "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday" }; // 
+Status Scheduler::addEventTo(int date, const Event& event) { // Add an event to a day, materializing the day if needed
+    const Day* day = days.find(date);
+    if (day != nullptr && day->isDayOff) { // checked before the day is taken for writing, so a rejected event leaves it unstamped
+        return Status(ErrorKind::Day, 1);
+    }
+    Status status = days.getOrCreate(date).tryAddEvent(event);
+    if (!status.isOk()) {
+        days.release(date); // do not keep a day that was only created for the rejected event
+    }
+    return status;
+}
 
-    for (int i = 0; i < 31; ++i) { 
-        days[i] = Day(i + 1, daysOfWeek[i % 7]); // To decide the day when given the date
+void Scheduler::addSingleEvent(int date, Event& event) { // Add a non-repeating event after checking the series that occur on the day
+    if (!ConflictChecker::findConflicts(date, event, days, rules).empty()) {
+        throw EventExceptions(1);
     }
+    addEventTo(date, event).throwIfError();
 }
 
-void Scheduler::saveEventsTo_txt() { // Function to save the events to the text file
-    ofstream file("EventFile.txt");
+void Scheduler::skipDaysOff(RecurrenceRule& rule) const { // Repeating events are not scheduled on the days that are already off
+    days.forEachInRange(rule.firstDay, rule.lastDay, [&rule](const Day& day) {
+        if (day.isDayOff && rule.matchesPattern(day.date)) {
+            rule.exceptions.insert(day.date);
+        }
+    });
+}
+
+RecurrenceRule& Scheduler::addRule(RecurrenceRule& rule) { // Add a repeating series after checking it against everything it could overlap
+    const Day* firstDay = days.find(rule.firstDay);
+    if (firstDay != nullptr && firstDay->isDayOff && rule.exceptions.count(rule.firstDay) == 0) { // an export keeps a series whose first day went off, with that day cancelled
+        throw DayExceptions(1);
+    }
+    if (!ConflictChecker::findConflicts(rule, days, rules).empty()) {
+        throw EventExceptions(1);
+    }
+    skipDaysOff(rule);
+    return rules.add(rule);
+}
+
+void Scheduler::printConflicts(const vector<Conflict>& conflicts) const {
+    for (const Conflict& conflict : conflicts) {
+        cout << setColor("   Conflicts with " + conflict.title + " on " + Date::fromDayNumber(conflict.date).toLongString() + "\n", 12);
+    }
+}
+
+shared_ptr<const CalendarState> Scheduler::readState() const {
+    if (concurrentReads.load(memory_order_acquire)) {
+        return atomic_load(&published);
+    }
+    return shared_ptr<const CalendarState>(shared_ptr<const CalendarState>(), &state); // only one thread uses the scheduler, so it can read the working state
+}
+
+void Scheduler::publish() { // Readers keep the version they loaded, the next write clones only the segments it touches
+    if (concurrentReads.load(memory_order_relaxed)) {
+        atomic_store(&published, shared_ptr<const CalendarState>(make_shared<CalendarState>(state)));
+        state.markPublished();
+    }
+}
+
+void Scheduler::enableConcurrentReads() {
+    lock_guard<mutex> lock(writerMutex);
+    atomic_store(&published, shared_ptr<const CalendarState>(make_shared<CalendarState>(state)));
+    state.markPublished();
+    concurrentReads.store(true, memory_order_release); // readers only switch to the published state once it exists
+}
+
+OccupancyBitmap Scheduler::busyMinutes(int date) const {
+    return readState()->busyMinutes(date);
+}
+
+void Scheduler::saveEventsTo_txt(const string& path) const { // Function to export the events to a text file
+    StatsTimer timer(StatOperation::SaveText);
+    ofstream file(path);
     if (!file.is_open()) {
         throw SchedulerExceptions(4);
     }
 
-    for (int i = 0; i < 31; ++i) {
-        file << days[i].formatDayDataToString(); // Write the day data to the file
-    }
+    string buffer; // the lines are formatted straight into one buffer that is written out whenever it fills up
+    buffer.reserve(TEXT_BUFFER_SIZE + 4096);
+    auto writeFull = [&file, &buffer]() {
+        if (buffer.size() >= TEXT_BUFFER_SIZE) {
+            file.write(buffer.data(), (streamsize)buffer.size());
+            buffer.clear();
+        }
+    };
+    shared_ptr<const CalendarState> current = readState();
+    current->days.forEach([&](const Day& day) {
+        day.appendDayData(buffer); // Write the day data to the file
+        writeFull();
+    });
+    current->rules.forEach([&](const RecurrenceRule& rule) {
+        rule.appendRuleData(buffer); // Write each series once
+        writeFull();
+    });
+    file.write(buffer.data(), (streamsize)buffer.size());
     file.close();
+    if (!file) {
+        throw SchedulerExceptions(4);
+    }
 }
 
-void Scheduler::loadEventsFrom_txt() { // Function to load the events from the text file
-    ifstream file("EventFile.txt");
+void Scheduler::saveEventsTo_ics(const string& path) const { // Export the events as an iCalendar file
+    StatsTimer timer(StatOperation::SaveIcs);
+    ofstream file(path, ios::binary);
     if (!file.is_open()) {
+        throw SchedulerExceptions(4);
+    }
+
+    IcsWriter writer;
+    string buffer;
+    buffer.reserve(TEXT_BUFFER_SIZE + 4096);
+    auto writeFull = [&file, &buffer]() {
+        if (buffer.size() >= TEXT_BUFFER_SIZE) {
+            file.write(buffer.data(), (streamsize)buffer.size());
+            buffer.clear();
+        }
+    };
+    writer.appendHeader(buffer);
+    shared_ptr<const CalendarState> current = readState();
+    current->days.forEach([&](const Day& day) {
+        if (day.isDayOff) {
+            writer.appendDayOff(buffer, day.date);
+        }
+        for (int i = 0; i < (int)day.events.size(); ++i) {
+            writer.appendEvent(buffer, day.date, day.events[i], i);
+            writeFull();
+        }
+        writeFull();
+    });
+    current->rules.forEach([&](const RecurrenceRule& rule) {
+        writer.appendRule(buffer, rule);
+        writeFull();
+    });
+    writer.appendFooter(buffer);
+    file.write(buffer.data(), (streamsize)buffer.size());
+    file.close();
+    if (!file) {
+        throw SchedulerExceptions(4);
+    }
+}
+
+vector<ImportConflict> Scheduler::importFrom_ics(const string& path) { // Import an iCalendar file one event at a time
+    StatsTimer timer(StatOperation::LoadIcs);
+    lock_guard<mutex> lock(writerMutex);
+    IcsReader reader(path);
+    if (!reader.isOpen()) {
         throw SchedulerExceptions(5);
     }
 
-    string line;
-    while (getline(file, line)) {
-        if (line.empty()) continue;
-        int date;
-        stringstream lineStream(line);
-        string dateStr;
-        getline(lineStream, dateStr, '|');
-        date = stoi(dateStr);
-        days[date - 1].extractDayData(line);
+    vector<ImportConflict> conflicts;
+    startStep(); // the whole import is undone in one step
+    IcsEvent imported;
+    while (reader.next(imported)) {
+        if (!imported.problem.empty()) {
+            conflicts.push_back({ imported.line, imported.date, imported.title, imported.problem });
+            continue;
+        }
+        if (imported.isDayOff) { // as in the text format, a day off replaces the events of the day and cancels the series on it
+            applySetDayOff(imported.date);
+            continue;
+        }
+
+        try {
+            Event event(Title(imported.title), imported.startTime, imported.endTime, imported.repeatType);
+            if (imported.repeatType == RepeatType::None) {
+                addSingleEvent(imported.date, event);
+                continue;
+            }
+            RecurrenceRule rule(0, event, imported.date, imported.lastDay);
+            rule.period = imported.period;
+            rule.exceptions.insert(imported.exceptions.begin(), imported.exceptions.end());
+            addRule(rule);
+        }
+        catch (const exception& exception) {
+            conflicts.push_back({ imported.line, imported.date, imported.title, exception.what() });
+        }
+    }
+    finishStep(true);
+    publish();
+    return conflicts;
+}
+
+void Scheduler::loadEventsFrom_txt(const string& path) { // Function to import the events from a text file
+    StatsTimer timer(StatOperation::LoadText);
+    lock_guard<mutex> lock(writerMutex);
+    MappedFile file; // the whole file is parsed in place
+    if (!file.open(path)) {
+        throw SchedulerExceptions(5);
     }
-    file.close();
 
-    /*
-     * Referred from https://www.digitalocean.com/community/tutorials/getline-in-c-plus-plus
-     */
+    unordered_set<int> legacySeries; // ids of the series written as one line per occurrence, their lastDay is the latest copy read so far
+
+    startStep(); // the whole import is undone in one step, including the lines read before a malformed one
+    try {
+        TextParser parser(string_view(file.begin(), file.size()));
+        TextLine line;
+        while (parser.next(line)) {
+            int date = line.date;
+
+            if (line.isDayOff) { // If the day is off, set the day off status and cancel the occurrences of the series read so far
+                applySetDayOff(date);
+                continue;
+            }
+
+            if (line.repeatType == RepeatType::None) {
+                Event event(Title(line.title), line.startTime, line.endTime, line.repeatType);
+                addSingleEvent(date, event);
+                continue;
+            }
+            addSeriesLine(line, legacySeries);
+        }
+    }
+    catch (const exception&) {
+        finishStep(true);
+        publish();
+        throw;
+    }
+    finishStep(true);
+    publish();
 }
 
-void Scheduler::option_list(int index) { // Function to display the options in the command instruct
-    string option_list[8] = { "       1. Schedule an Event","      2. Cancel an Event","      3. Shift an Event","      4. Set a Day Off","      5. View Day Schedule","               6. View Week Schedule","\t\t\t      7. View Month Schedule","\t      8. Exit" };
-    cout << setColor(option_list[index], 14);
-    cout << endl;
+void Scheduler::addSeriesLine(const TextLine& line, unordered_set<int>& legacySeries) { // Add a series read from the text format
+    int date = line.date;
+    Event event(Title(line.title), line.startTime, line.endTime, line.repeatType);
+
+    if (line.hasLimits) {
+        RecurrenceRule rule(0, event, date, line.lastDay);
+        if (line.period != 0) {
+            rule.period = line.period;
+        }
+        TextParser::forEachDate(line.exceptions, [&rule](int exception) {
+            rule.exceptions.insert(exception);
+        });
+        addRule(rule);
+        return;
+    }
+
+    // Older files stored a copy of the event on every day of the series: fold the copies back into one rule
+    const RecurrenceRule* series = nullptr;
+    rules.forEachWithTitle(event.title, [&](const RecurrenceRule& candidate) { // only the series with the same title can take the copy
+        if (series == nullptr && legacySeries.count(candidate.id) != 0 && candidate.event.startTime == event.startTime && candidate.event.endTime == event.endTime
+            && candidate.event.repeatType == event.repeatType && date > candidate.lastDay && (date - candidate.firstDay) % candidate.period == 0) {
+            series = &candidate;
+        }
+    });
+
+    if (series == nullptr) {
+        RecurrenceRule rule(0, event, date, date);
+        legacySeries.insert(addRule(rule).id);
+        return;
+    }
+
+    const Day* day = days.find(date);
+    if (day != nullptr && day->conflictsWith(event)) {
+        throw EventExceptions(1);
+    }
+    RecurrenceRule* writableSeries = rules.writableRule(series->id);
+    for (int skipped = writableSeries->lastDay + writableSeries->period; skipped < date; skipped += writableSeries->period) {
+        writableSeries->exceptions.insert(skipped); // the copy on this day had been cancelled
+    }
+    writableSeries->lastDay = date;
 }
 
+vector<ImportConflict> Scheduler::bulkImportFrom_txt(const string& path, ThreadPool& pool) { // Import a large text file on all cores
+    StatsTimer timer(StatOperation::BulkImport);
+    lock_guard<mutex> lock(writerMutex);
+    MappedFile file;
+    if (!file.open(path)) {
+        throw SchedulerExceptions(5);
+    }
+
+    vector<ImportedLine> seriesLines;
+    vector<int> daysOff;
+    startStep();
+    BulkImporter importer(pool);
+    vector<ImportConflict> conflicts = importer.importDays(string_view(file.begin(), file.size()), days, rules, seriesLines, daysOff);
+    for (int date : daysOff) {
+        applySetDayOff(date); // cancel the occurrences of the stored series, as for a day off set any other way
+    }
+
+    unordered_set<int> legacySeries;
+    for (const ImportedLine& line : seriesLines) { // the series are checked against the days that were just built
+        try {
+            addSeriesLine(line.text, legacySeries);
+        }
+        catch (const exception& exception) {
+            conflicts.push_back({ line.line, line.text.date, string(line.text.title), exception.what() });
+        }
+    }
+    finishStep(true);
+    publish();
+    return conflicts;
+}
+
+Expected<vector<Conflict>> Scheduler::applySchedule(int date, const Event& event, bool overrideDayOff) { // Store an event or a series unless it overlaps something
+    const Day* day = days.find(date); // read only until the event is accepted, so a rejected one changes no version
+    if (day != nullptr && day->isDayOff && !overrideDayOff) {
+        return Status(ErrorKind::Day, 1);
+    }
+
+    Event newEvent = event;
+    RecurrenceRule rule(0, newEvent, date);
+    vector<Conflict> conflicts = (event.repeatType != RepeatType::None) ? ConflictChecker::findConflicts(rule, days, rules) // Find every conflict before anything is stored
+                                                                        : ConflictChecker::findConflicts(date, newEvent, days, rules);
+    if (!conflicts.empty()) {
+        return conflicts;
+    }
+
+    if (day != nullptr && day->isDayOff) { // The day off is given up for the event
+        days.writableDay(date)->isDayOff = false;
+        days.release(date);
+    }
+    if (event.repeatType != RepeatType::None) { // Repeating events are stored once as a series and expanded when a day is looked at
+        skipDaysOff(rule);
+        rules.add(rule);
+    }
+    else {
+        Status status = addEventTo(date, newEvent);
+        if (!status.isOk()) {
+            return status;
+        }
+    }
+    return conflicts;
+}
+
+Status Scheduler::applyCancel(int date, Title title, bool deleteRepeats) {
+    const Day* day = days.find(date); // the lookups are read only, the day or series is taken for writing once it is found
+    const RecurrenceRule* rule = rules.findOccurrence(date, title);
+
+    if (rule != nullptr && deleteRepeats) { // If deleteRepeats is true, cancel this and all later occurrences of the series
+        if (date <= rule->firstDay) {
+            rules.remove(rule->id);
+        }
+        else {
+            rules.writableRule(rule->id)->cancelFrom(date);
+        }
+    }
+    else if (rule != nullptr && (day == nullptr || day->findEvent(title) == nullptr)) { // Cancel only this occurrence of the series
+        rules.writableRule(rule->id)->exceptions.insert(date);
+    }
+    else {
+        if (day == nullptr || day->findEvent(title) == nullptr) {
+            return Status(ErrorKind::Event, 3);
+        }
+        Status status = days.writableDay(date)->tryDeleteEvent(title);
+        days.release(date);
+        return status;
+    }
+    return Status();
+}
+
+Status Scheduler::applyShift(int date, Title title, int newDate) {
+    const Day* day = days.find(date); // read only until the shift is accepted
+    const Event* storedEvent = (day != nullptr) ? day->findEvent(title) : nullptr;
+    const RecurrenceRule* rule = rules.findOccurrence(date, title);
+
+    if (storedEvent != nullptr) {
+        if (!ConflictChecker::findConflicts(newDate, *storedEvent, days, rules).empty()) { // Check the new date, including the series that occur on it
+            return Status(ErrorKind::Event, 7);
+        }
+        const Day* newDay = days.find(newDate);
+        if (newDay != nullptr && newDay->isDayOff) { // turned down here rather than by tryShiftEvent(), which only sees it after both days were taken
+            return Status(ErrorKind::Day, 1);
+        }
+        Day* writableDay = days.writableDay(date);
+        Status status = writableDay->tryShiftEvent(title, days.getOrCreate(newDate));
+        days.release(newDate);
+        days.release(date);
+        return status;
+    }
+    else if (rule != nullptr) { // A shifted occurrence leaves the series and becomes a single event on the new date
+        Event eventToShift = rule->event;
+        eventToShift.repeatType = RepeatType::None;
+        if (!ConflictChecker::findConflicts(newDate, eventToShift, days, rules).empty()) {
+            return Status(ErrorKind::Event, 7);
+        }
+        Status status = addEventTo(newDate, eventToShift);
+        if (status.isOk()) {
+            rules.writableRule(rule->id)->exceptions.insert(date);
+        }
+        return status;
+    }
+    return Status(ErrorKind::Event, 3);
+}
+
+void Scheduler::applySetDayOff(int date) {
+    Day& day = days.getOrCreate(date);
+    day.isDayOff = true; // Set the day as a day off
+    day.clearEvents(); // Clear all events on the day
+
+    vector<int> occurring; // found first, so that the series are only cloned if one of them changes
+    rules.forEachOccurringOn(date, [&occurring](const RecurrenceRule& rule) {
+        occurring.push_back(rule.id);
+    });
+    for (int id : occurring) { // Cancel the occurrences of the series on the day
+        rules.writableRule(id)->exceptions.insert(date);
+    }
+}
+
+Status Scheduler::applyRecord(const JournalRecord& record) { // Redo a change read back from the journal
+    switch (record.kind) {
+    case 'S':
+        return applySchedule(record.date, record.event, record.flag).error();
+    case 'C':
+        return applyCancel(record.date, record.event.title, record.flag);
+    case 'M':
+        return applyShift(record.date, record.event.title, record.newDate);
+    case 'O':
+        applySetDayOff(record.date);
+        break;
+    }
+    return Status();
+}
 
-Scheduler::Scheduler(int currentDay) { // Constructor for the Scheduler class
+void Scheduler::journalChange(const JournalRecord& record) { // Only the change is written, never the whole calendar
+    journal.append(record);
+    if (journal.isCommitDue()) {
+        syncJournal(); // a failed write leaves the records pending, the next sync() retries them and reports it
+    }
+    publish();
+}
+
+void Scheduler::option_list(int index, Renderer& frame) const { // Function to display the options in the command instruct
+    string option_list[12] = { "1. Schedule an Event","2. Cancel an Event","3. Shift an Event","4. Set a Day Off","5. View Day Schedule","6. View Week Schedule","7. View Month Schedule","8. Find a Free Slot","9. View Statistics","10. Undo Last Change","11. Redo Change","12. Exit" };
+    frame.append("      ");
+    frame.append(option_list[index], 14);
+    frame.append("\n");
+}
+
+
+Scheduler::Scheduler(int currentDay, const string& dataPath, bool readOnly) : days(state.days), rules(state.rules), journal(dataPath + ".journal"), snapshot(dataPath + ".bin") { // Constructor for the Scheduler class
     this->currentDay = currentDay;
+    this->concurrentReads = false;
+    this->readOnly = readOnly;
+    uint32_t snapshotSequence = 0;
+    bool hasSnapshot = fileExists(snapshot.getPath());
+    try {
+        if (hasSnapshot) { // The snapshot is the main file, the text file is only imported when there is no snapshot yet
+            StatsTimer timer(StatOperation::LoadSnapshot);
+            snapshotSequence = snapshot.load(days, rules);
+        }
+        else {
+            loadEventsFrom_txt(dataPath + ".txt");
+        }
+    }
+    catch (const exception& exception) {
+        cerr << setColor("   Error : ", 12) << setColor(exception.what(), 12) << "\n";
+    }
+    undoSteps.clear(); // loading the calendar is not a change that can be undone
+
     try {
-        initializeDays();
-        loadEventsFrom_txt();
+        for (const JournalRecord& record : journal.open(snapshotSequence, !readOnly)) { // Replay the changes made after the snapshot was written
+            applyRecord(record); // a change that is rejected now was rejected when it was first made as well, so there is nothing to redo
+        }
+        if (!readOnly && (!hasSnapshot || journal.needsCompaction(days.size() + rules.size()))) {
+            compact();
+        }
     }
     catch (const exception& exception) {
-        cout << setColor("   Error : ", 12) << setColor(exception.what(), 12) << endl;
+        cerr << setColor("   Error : ", 12) << setColor(exception.what(), 12) << "\n";
     }
 }
 
 
 Scheduler::~Scheduler() {
+    Status status = sync(); // the changes are already in the journal, so exiting does not rewrite the calendar
+    if (!status.isOk()) {
+        cerr << setColor("   Error: ", 12) << setColor(status.message(), 12) << "\n";
+    }
+}
+
+Status Scheduler::sync() {
+    lock_guard<mutex> lock(writerMutex);
+    return syncJournal();
+}
+
+Status Scheduler::syncJournal() {
+    if (readOnly) {
+        return Status();
+    }
     try {
-        saveEventsTo_txt();
+        journal.sync();
     }
-    catch (const exception& exception) {
-        cout << setColor("   Error ", 12) << setColor(exception.what(), 12) << endl;
+    catch (const exception&) {
+        return Status(ErrorKind::Scheduler, 4); // the records stay pending, the changes are made but not durable yet
+    }
+    try {
+        if (journal.needsCompaction(days.size() + rules.size())) {
+            writeSnapshot();
+        }
     }
+    catch (const exception& exception) { // the changes are durable in the journal, which is folded in with a later sync
+        cerr << setColor("   Error: ", 12) << setColor(exception.what(), 12) << "\n";
+    }
+    return Status();
+}
+
+void Scheduler::compact() {
+    lock_guard<mutex> lock(writerMutex);
+    writeSnapshot();
+}
+
+void Scheduler::writeSnapshot() {
+    if (readOnly) {
+        throw SchedulerExceptions(4);
+    }
+    StatsTimer timer(StatOperation::SaveSnapshot);
+    snapshot.save(days, rules, journal.sequence()); // only the segments changed since the last save are written, the journal is only emptied once the snapshot holds every change
+    journal.clear();
+}
+
+Expected<vector<Conflict>> Scheduler::trySchedule(int date, const Event& event, bool overrideDayOff) {
+    StatsTimer timer(StatOperation::Schedule); // the wait for the writer lock is part of the latency
+    lock_guard<mutex> lock(writerMutex); // writers take turns, readers never wait for them
+    if (date < currentDay) {
+        timer.fail();
+        return Status(ErrorKind::Day, 4);
+    }
+    startStep();
+    Expected<vector<Conflict>> conflicts = applySchedule(date, event, overrideDayOff);
+    finishStep(conflicts.hasValue() && conflicts->empty());
+    timer.fail(!conflicts.hasValue() || !conflicts->empty());
+    if (conflicts.hasValue() && conflicts->empty()) {
+        JournalRecord record('S', date);
+        record.flag = overrideDayOff;
+        record.event = event;
+        journalChange(record);
+    }
+    return conflicts;
+}
+
+Status Scheduler::tryCancel(int date, const string& title, bool deleteRepeats) {
+    StatsTimer timer(StatOperation::Cancel);
+    lock_guard<mutex> lock(writerMutex);
+    if (date < currentDay) {
+        timer.fail();
+        return Status(ErrorKind::Day, 4);
+    }
+    Title storedTitle;
+    if (!Title::find(title, storedTitle)) { // a title that was never seen cannot belong to any event, so it is not added to the pool
+        timer.fail();
+        return Status(ErrorKind::Event, 3);
+    }
+    startStep();
+    Status status = applyCancel(date, storedTitle, deleteRepeats);
+    finishStep(status.isOk());
+    timer.fail(!status.isOk());
+    if (status.isOk()) {
+        JournalRecord record('C', date);
+        record.flag = deleteRepeats;
+        record.event.title = storedTitle;
+        journalChange(record);
+    }
+    return status;
+}
+
+Status Scheduler::tryShift(int date, const string& title, int newDate) {
+    StatsTimer timer(StatOperation::Shift);
+    lock_guard<mutex> lock(writerMutex);
+    if (date < currentDay || newDate < currentDay) {
+        timer.fail();
+        return Status(ErrorKind::Event, 5);
+    }
+    Title storedTitle;
+    if (!Title::find(title, storedTitle)) {
+        timer.fail();
+        return Status(ErrorKind::Event, 3);
+    }
+    startStep();
+    Status status = applyShift(date, storedTitle, newDate);
+    finishStep(status.isOk());
+    timer.fail(!status.isOk());
+    if (status.isOk()) {
+        JournalRecord record('M', date);
+        record.newDate = newDate;
+        record.event.title = storedTitle;
+        journalChange(record);
+    }
+    return status;
+}
+
+Status Scheduler::tryMarkDayOff(int date) {
+    StatsTimer timer(StatOperation::DayOff);
+    lock_guard<mutex> lock(writerMutex);
+    if (date < currentDay) {
+        timer.fail();
+        return Status(ErrorKind::Day, 4);
+    }
+    startStep();
+    applySetDayOff(date);
+    finishStep(true);
+    journalChange(JournalRecord('O', date));
+    return Status();
+}
+
+void Scheduler::startStep() {
+    pendingStep = CalendarState::Change();
+    state.record(&pendingStep);
+}
+
+void Scheduler::finishStep(bool changed) {
+    state.record(nullptr);
+    if (changed) {
+        keepStep(pendingStep);
+    }
+}
+
+void Scheduler::keepStep(CalendarState::Change& step) {
+    undoSteps.push_back(move(step));
+    if (undoSteps.size() > UNDO_LIMIT) {
+        undoSteps.pop_front();
+    }
+    redoSteps.clear(); // a new change starts a new line of history
+}
+
+Status Scheduler::saveStep(CalendarState::Change& step) { // The journal only replays changes forward, so the reverted segments go straight into the snapshot
+    try {
+        writeSnapshot();
+    }
+    catch (const exception&) {
+        state.revert(step); // the calendar stays as it is on the disk
+        return Status(ErrorKind::Scheduler, 4);
+    }
+    publish();
+    return Status();
+}
+
+Status Scheduler::tryUndo() {
+    lock_guard<mutex> lock(writerMutex);
+    if (undoSteps.empty()) {
+        return Status(ErrorKind::Scheduler, 7);
+    }
+    state.revert(undoSteps.back());
+    Status status = saveStep(undoSteps.back());
+    if (status.isOk()) {
+        redoSteps.push_back(move(undoSteps.back())); // the step now holds what the undo replaced
+        undoSteps.pop_back();
+    }
+    return status;
+}
+
+Status Scheduler::tryRedo() {
+    lock_guard<mutex> lock(writerMutex);
+    if (redoSteps.empty()) {
+        return Status(ErrorKind::Scheduler, 8);
+    }
+    state.revert(redoSteps.back());
+    Status status = saveStep(redoSteps.back());
+    if (status.isOk()) {
+        undoSteps.push_back(move(redoSteps.back()));
+        redoSteps.pop_back();
+    }
+    return status;
+}
+
+Status Scheduler::trySaveVersion(const string& name) {
+    lock_guard<mutex> lock(writerMutex);
+    savedVersions[name] = state; // shares every segment and the series, so it costs a pointer until the calendar changes
+    return Status();
+}
+
+Status Scheduler::tryRestoreVersion(const string& name) {
+    lock_guard<mutex> lock(writerMutex);
+    auto version = savedVersions.find(name);
+    if (version == savedVersions.end()) {
+        return Status(ErrorKind::Scheduler, 9);
+    }
+    CalendarState::Change step;
+    state.restore(version->second, step);
+    Status status = saveStep(step);
+    if (status.isOk()) {
+        keepStep(step);
+    }
+    return status;
+}
+
+vector<string> Scheduler::savedVersionNames() {
+    lock_guard<mutex> lock(writerMutex);
+    vector<string> names;
+    for (auto it = savedVersions.begin(); it != savedVersions.end(); ++it) {
+        names.push_back(it->first);
+    }
+    return names;
+}
+
+vector<Conflict> Scheduler::schedule(int date, const Event& event, bool overrideDayOff) {
+    return trySchedule(date, event, overrideDayOff).valueOrThrow();
+}
+
+void Scheduler::cancel(int date, const string& title, bool deleteRepeats) {
+    tryCancel(date, title, deleteRepeats).throwIfError();
+}
+
+void Scheduler::shift(int date, const string& title, int newDate) {
+    tryShift(date, title, newDate).throwIfError();
+}
+
+void Scheduler::markDayOff(int date) {
+    tryMarkDayOff(date).throwIfError();
+}
+
+Day Scheduler::daySchedule(int date) const {
+    return readState()->expandDay(date);
 }
 
 void Scheduler::scheduleEvent(int date, Event& event) { // Function to schedule an event
     try {
-        if (date < currentDay || date > 31) {
+        if (date < currentDay) {
             throw DayExceptions(4);
         }
 
-        if (days[date - 1].isDayOff){  // Check if the day is marked as a day off
+        bool overrideDayOff = false;
+        const Day* day = readState()->days.find(date);
+        if (day != nullptr && day->isDayOff){  // Check if the day is marked as a day off
             string confirmation;
             cout << setColor("      The selected day is marked as a day off. Do you want to proceed? (", 15);
             cout << setColor("yes", 10);
@@ -113,224 +761,286 @@ void Scheduler::scheduleEvent(int date, Event& event) { // Function to schedule
                 cout << setColor("Event not scheduled as the day is marked as a day off.\n", 12);
                 return;
             }
-
-            days[date - 1].isDayOff = false; // Remove the day off status if user confirms
+            overrideDayOff = true; // Remove the day off status if user confirms
         }
 
-        Event newEvent = event; 
-        newEvent.repeatType = event.repeatType;
-
-        if (event.repeatType == "daily") { // Check if the event is repeating daily
-            for (int i = date; i <= 31; ++i) {
-                if (!days[i - 1].isDayOff) {
-                    days[i - 1].addEvent(newEvent);
-                }
-            }
-        }
-        else if (event.repeatType == "weekly") { // Check if the event is repeating weekly
-            for (int i = date; i <= 31; i += 7) {
-                if (!days[i - 1].isDayOff) {
-                    days[i - 1].addEvent(newEvent);
-                }
-            }
+        vector<Conflict> conflicts = schedule(date, event, overrideDayOff);
+        if (!conflicts.empty()) {
+            printConflicts(conflicts);
+            throw EventExceptions(1);
         }
-        else {
-            days[date - 1].addEvent(newEvent); // 
-        }
-
         cout << setColor("   Event scheduled successfully.\n", 10);
     }
     catch (const exception& exception) {
-        cout << setColor("   Error: ", 12) << setColor(exception.what(), 12) << endl;
+        cout << setColor("   Error: ", 12) << setColor(exception.what(), 12) << "\n";
     }
 }
 
 
 void Scheduler::cancelEvent(int date, string& title, bool deleteRepeats) { // Function to cancel an event
     try {
-        if (date < currentDay || date > 31) {
-            throw DayExceptions(4);
-        }
-
-        if (!deleteRepeats) { // If deleteRepeats is true, delete all occurrences of the event in the future
-            for (int i = date - 1; i < 31; ++i) {
-                bool eventFound = true;
-
-                while (eventFound) {
-                    eventFound = false;
-
-                    for (int j = 0; j < days[i].eventCount; ++j) { 
-                        if (days[i].events[j].title == title) { // Check if the event is found
-                            days[i].deleteEvent(title); // if found, delete the event
-                            eventFound = true; // Continue to check for more instances of the event on this day
-                            break; // Exit the for loop to check the updated list
-                        }
-                    }
-                }
-            }
-        }
-        else {
-            days[date - 1].deleteEvent(title);
-        }
-
+        cancel(date, title, deleteRepeats);
         cout << setColor("   Event cancelled successfully.\n", 12);
     }
     catch (const exception& exception) {
-        cout << setColor("   Error: ", 12) << setColor(exception.what(), 12) << endl;
+        cout << setColor("   Error: ", 12) << setColor(exception.what(), 12) << "\n";
     }
 }
 
 void Scheduler::shiftEvent(int date, string& title, int newDate) { // Function to shift an event
     try {
-        if (date < currentDay || date > 31 || newDate < currentDay || newDate > 31) {
-            throw EventExceptions(5);
-        }
-        days[date - 1].shiftEvent(title, newDate, days);
+        shift(date, title, newDate);
         cout << setColor("   Event shifted successfully.\n", 10);
     }
     catch (const exception& exception) {
-        cout << setColor("   Error: ", 12) << setColor(exception.what(), 12) << endl;
+        cout << setColor("   Error: ", 12) << setColor(exception.what(), 12) << "\n";
     }
 }
 
 void Scheduler::setDayOff(int date) { // Function to set a day off
     try {
-        if (date < currentDay || date > 31) {
-            throw DayExceptions(4);
-        }
-        days[date - 1].isDayOff = true; // Set the day as a day off
-        days[date - 1].clearEvents(); // Clear all events on the day
-        cout << setColor("   Day off set for ", 10) << setColor(to_string(date), 10) << setColor(" July 2024.\n", 10);
+        markDayOff(date);
+        cout << setColor("   Day off set for ", 10) << setColor(Date::fromDayNumber(date).toLongString(), 10) << setColor(".\n", 10);
     }
     catch (const exception& exception) {
-        cout << setColor("   Error: ", 12) << setColor(exception.what(), 12) << endl;
+        cout << setColor("   Error: ", 12) << setColor(exception.what(), 12) << "\n";
+    }
+}
+
+void Scheduler::undoChange() { // Function to undo the last change
+    Status status = tryUndo();
+    if (status.isOk()) {
+        cout << setColor("   The last change was undone.\n", 10);
+    }
+    else {
+        cout << setColor("   Error: ", 12) << setColor(status.message(), 12) << "\n";
+    }
+}
+
+void Scheduler::redoChange() { // Function to redo the last change that was undone
+    Status status = tryRedo();
+    if (status.isOk()) {
+        cout << setColor("   The change was made again.\n", 10);
+    }
+    else {
+        cout << setColor("   Error: ", 12) << setColor(status.message(), 12) << "\n";
     }
 }
 
 void Scheduler::viewWeekSchedule(int startDay) const { // Function to view the week schedule
-    if (startDay < 1 || startDay > 31) {
-        throw DayExceptions(5);
+    StatsTimer timer(StatOperation::Render);
+    Renderer frame;
+    renderWeekSchedule(startDay, frame);
+    frame.present();
+}
+
+void Scheduler::viewDaySchedule(int day) const { // Function to view the day schedule
+    StatsTimer timer(StatOperation::Render);
+    Renderer frame;
+    renderDaySchedule(day, frame);
+    frame.present();
+}
+
+void Scheduler::displayScheduler(int date) const { // Function to display the monthly schedule
+    StatsTimer timer(StatOperation::Render);
+    Renderer frame;
+    renderMonthSchedule(date, frame);
+    frame.present();
+}
+
+void Scheduler::renderDaySchedule(int day, Renderer& frame) const {
+    shared_ptr<const CalendarState> current = readState();
+    lock_guard<mutex> lock(renderMutex);
+    frame.append("   ");
+    frame.append(renderCache.dayText(*current, day), 9);
+    frame.append("\n");
+}
+
+void Scheduler::renderWeekSchedule(int startDay, Renderer& frame) const {
+    int startIndex = startDay - Date::dayOfWeek(startDay); // Calculate the Sunday that starts the week of the given date
+    int endIndex = startIndex + 6; // Calculate the Saturday that ends the week
+
+    shared_ptr<const CalendarState> current = readState(); // the whole view shows one version of the calendar
+    lock_guard<mutex> lock(renderMutex);
+    const string* cached = renderCache.findView(RenderView::Week, startIndex, *current, startIndex, endIndex, true);
+    if (cached != nullptr) { // no day of the week has changed since it was drawn
+        frame.append(*cached);
+        return;
     }
 
-    int startIndex = ((startDay) / 7) * 7; // Calculate the starting date of the week given a date
-    int endIndex = startIndex + 7; // Calculate the ending date of the week given a date
-    if (startIndex >= 28) endIndex = 31; // If the week starts on the 28th or later, set the end date to 31
+    Renderer view;
+    for (int i = startIndex; i <= endIndex; ++i) { // Display the schedule for each day for the selected week
+        const string& output = renderCache.dayText(*current, i);
 
-    for (int i = (startIndex == 0 ? 1 : startIndex); i < endIndex; ++i) { // Display the schedule for each day for the selected week
-        string output = days[i - 1].toString();
-   
         if (!output.empty()) { // Check if the day has any events and if it is empty, do not display the day
-            cout << "   " << setColor(output, 9); // if the day has events, display the day with the events
+            view.append("   ");
+            view.append(output, 9); // if the day has events, display the day with the events
         }
     }
+    renderCache.storeView(view.text());
+    frame.append(view.text());
 }
 
-void Scheduler::viewDaySchedule(int day) const { // Function to view the day schedule
-    if (day < 1 || day > 31) {
-        throw DayExceptions(3);
+void Scheduler::renderMonthSchedule(int date, Renderer& frame) const {
+    Date month = Date::fromDayNumber(date);
+    int firstDay = date - month.day + 1;
+    int lastDay = lastDayOfMonth(date);
+
+    shared_ptr<const CalendarState> current = readState();
+    lock_guard<mutex> lock(renderMutex);
+    const string* cached = renderCache.findView(RenderView::Month, firstDay, *current, firstDay, lastDay, true);
+    if (cached != nullptr) {
+        frame.append(*cached);
+        return;
     }
-    cout << "   " << setColor(days[day - 1].toString(), 9) << endl;
-}
 
-void Scheduler::displayScheduler() { // Function to display the monthly schedule
-    cout << setColor("\n\t\t\tSchedule - July 2024\n", 9);
-    for (int i = 0; i < 31; ++i) {
-        string dayStr = days[i].toString();
+    Renderer view;
+    view.append("\n\t\t\tSchedule - " + Date::monthName(month.month) + " " + to_string(month.year) + "\n", 9);
+    for (int i = firstDay; i <= lastDay; ++i) {
+        const string& dayStr = renderCache.dayText(*current, i);
 
         if (!dayStr.empty()) {
-            cout << "   " << setColor(dayStr, 9);
+            view.append("   ");
+            view.append(dayStr, 9);
+        }
+    }
+    renderCache.storeView(view.text());
+    frame.append(view.text());
+}
+
+static string formatDuration(uint64_t nanoseconds) { // three significant digits at most, in the unit that fits
+    char text[32];
+    if (nanoseconds < 1000) {
+        snprintf(text, sizeof(text), "%llu ns", (unsigned long long)nanoseconds);
+    }
+    else if (nanoseconds < 1000000) {
+        snprintf(text, sizeof(text), "%.3g us", nanoseconds / 1e3);
+    }
+    else if (nanoseconds < 1000000000) {
+        snprintf(text, sizeof(text), "%.3g ms", nanoseconds / 1e6);
+    }
+    else {
+        snprintf(text, sizeof(text), "%.3g s", nanoseconds / 1e9);
+    }
+    return text;
+}
+
+void Scheduler::viewStatistics() const { // Function to display the counts and latencies of the operations
+    Renderer frame;
+    if (!Stats::enabled) {
+        frame.append("   Statistics are not collected in this build.\n", 12);
+        frame.present();
+        return;
+    }
+    char line[160];
+    snprintf(line, sizeof(line), "   %-14s %8s %8s %10s %10s %10s %10s\n", "Operation", "Count", "Failed", "Mean", "Median", "99%", "Longest");
+    frame.append(line, 14);
+    for (const OperationStats& operation : Stats::collect()) {
+        if (operation.count == 0) {
+            continue;
         }
+        snprintf(line, sizeof(line), "   %-14s %8llu %8llu %10s %10s %10s %10s\n", operation.name.c_str(), (unsigned long long)operation.count, (unsigned long long)operation.failures,
+            formatDuration(operation.totalNanoseconds / operation.count).c_str(), formatDuration(operation.percentile(0.5)).c_str(),
+            formatDuration(operation.percentile(0.99)).c_str(), formatDuration(operation.maxNanoseconds).c_str());
+        frame.append(line, 9);
     }
+    frame.present();
 }
 
 bool Scheduler::isEventRepeating(int date, const string& title) const { // Function to check if the event is repeating
-    const Day& day = days[date - 1];
-    for (int i = 0; i < day.eventCount; ++i) {
-        if (day.events[i].title == title && day.events[i].repeatType != "none") {
-            return true;
+    Title storedTitle;
+    return Title::find(title, storedTitle) && readState()->rules.findOccurrence(date, storedTitle) != nullptr;
+}
+
+FreeSlot Scheduler::findFreeSlot(int duration, int firstDay, int lastDay, Time windowStart, Time windowEnd) const { // Scan the days in order, 64 minutes at a time
+    FreeSlot slot = { false, firstDay, windowStart, windowStart };
+    if (duration <= 0) {
+        return slot;
+    }
+
+    shared_ptr<const CalendarState> current = readState(); // every day is searched in the same version
+    for (int date = firstDay; date <= lastDay; ++date) { // a day off is busy from start to end
+        int start = current->busyMinutes(date).findFreeRun(duration, windowStart.toMinutes(), windowEnd.toMinutes());
+        if (start >= 0) {
+            slot = { true, date, Time::fromMinutes(start), Time::fromMinutes(start + duration) };
+            return slot;
         }
     }
-    return false;
+    return slot;
 }
 
 void Scheduler::displayScheduler_print(int today) { // Function to display the calendar in the command instruct
+    StatsTimer timer(StatOperation::Render);
+    Renderer frame; // the whole screen is composed first and written with one call
+    renderMonthCalendar(today, frame);
+    frame.present();
+}
+
+void Scheduler::renderMonthCalendar(int today, Renderer& frame) const {
+    Date todayDate = Date::fromDayNumber(today);
+    int firstDay = today - todayDate.day + 1;
+    int monthLength = Date::daysInMonth(todayDate.year, todayDate.month);
     int option_increment = 0;
-    cout << endl;
-    cout << setColor("======================================================", 11) << endl;
-    cout << setColor("                     2024 > July", 14) << endl;
-    cout << setColor("======================================================", 11) << endl << endl;
-    cout << setColor("   Su Mo Tu We Th Fr Sa", 14);
-    option_list(option_increment);
 
-    int startDay = 1; // 0 = Sunday, 1 = Monday, ..., 6 = Saturday
+    shared_ptr<const CalendarState> current = readState();
+    lock_guard<mutex> lock(renderMutex);
+    const string* cached = renderCache.findView(RenderView::MonthGrid, today, *current, firstDay, firstDay + monthLength - 1, false); // only the days off are marked
+    if (cached != nullptr) {
+        frame.append(*cached);
+        return;
+    }
 
-    for (int i = 0; i <= 31; ++i) {
-        if (i == 0) {
-            cout << "      ";
-        }
-        else if (i == today) {
-            SetConsoleTextAttribute(h, 176);
-            cout << setw(2) << setColor(to_string(i), 16) << " ";
-            SetConsoleTextAttribute(h, 11);
+    Renderer view;
+    view.append("\n");
+    view.append("======================================================", 11);
+    view.append("\n");
+    view.append("                     " + to_string(todayDate.year) + " > " + Date::monthName(todayDate.month), 14);
+    view.append("\n");
+    view.append("======================================================", 11);
+    view.append("\n\n");
+    view.append("   Su Mo Tu We Th Fr Sa ", 14);
+    option_list(option_increment++, view);
+
+    int column = Date::dayOfWeek(firstDay); // 0 = Sunday, 1 = Monday, ..., 6 = Saturday
+    view.append("   " + string(column * 3, ' '));
+
+    for (int i = 1; i <= monthLength; ++i) {
+        const Day* day = current->days.find(firstDay + i - 1);
+        string dayNumber = (i < 10 ? " " : "") + to_string(i);
+
+        if (firstDay + i - 1 == today) {
+            view.append(dayNumber, 16);
         }
-        else if (days[i - 1].toString_print()) {
-            SetConsoleTextAttribute(h, 12);
-            cout << setw(2) << setColor(to_string(i), 12) << " ";
-            SetConsoleTextAttribute(h, 11);
+        else if (day != nullptr && day->toString_print()) {
+            view.append(dayNumber, 12);
         }
         else {
-            cout << setw(2) << setColor(to_string(i), 11) << " ";
+            view.append(dayNumber, 11);
         }
-        if ((i + startDay) % 7 == 0) {
-            option_increment++;
-            option_list(option_increment);
-            //cout << endl;
-            cout << "   ";
+        view.append(" ");
+        if (++column == 7 || i == monthLength) { // Pad the week to the full width so that the options line up
+            view.append(string((7 - column) * 3, ' '));
+            option_list(option_increment++, view);
+            column = 0;
+            if (i < monthLength) {
+                view.append("   ");
+            }
         }
     }
-    option_list(5);
-    option_list(6);
-    cout << setColor("   XX", 12);
-    cout << setColor(" > Off Days", 14);
-    option_list(7);
-    cout << "\n";
-
-}
-
-string setColor(const string& txt, const int& color) {
-
-    switch (color) {
-    case 8:
-        SetConsoleTextAttribute(h, 8); // Light Ash
-        break;
-    case 9:
-        SetConsoleTextAttribute(h, 9); // Light Blue
-        break;
-    case 10:
-        SetConsoleTextAttribute(h, 10); // Light Green
-        break;
-    case 11:
-        SetConsoleTextAttribute(h, 11); // Light Aqua
-        break;
-    case 12:
-        SetConsoleTextAttribute(h, 12); // Light Red
-        break;
-    case 13:
-        SetConsoleTextAttribute(h, 13); // Light Purple
-        break;
-    case 14:
-        SetConsoleTextAttribute(h, 14); // Light Yello
-        break;
-    case 15:
-        SetConsoleTextAttribute(h, 15); // Light White
-        break;
-    case 16:
-        SetConsoleTextAttribute(h, 176); // Light White
-        break;
-    default:
-        SetConsoleTextAttribute(h, 8);  // Default color
-        break;
+    while (option_increment < 11) {
+        view.append(string(24, ' '));
+        option_list(option_increment++, view);
     }
+    view.append("   XX", 12);
+    view.append(" > Off Days", 14);
+    view.append(string(8, ' '));
+    option_list(11, view);
+    view.append("\n");
+    renderCache.storeView(view.text());
+    frame.append(view.text());
+}
 
-    return txt;
-}
\ No newline at end of file
+uint64_t Scheduler::builtViews() const {
+    lock_guard<mutex> lock(renderMutex);
+    return renderCache.builtViews();
+}
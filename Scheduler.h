@@ -1,35 +1,152 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_set>
 #include "Event.h"
 #include "Day.h"
+#include "DayStore.h"
+#include "RecurrenceStore.h"
+#include "CalendarState.h"
+#include "ConflictChecker.h"
+#include "Journal.h"
+#include "Snapshot.h"
+#include "TextParser.h"
+#include "BulkImporter.h"
+#include "ThreadPool.h"
+#include "Renderer.h"
+#include "RenderCache.h"
 #include "EventExceptions.h"
+#include "Status.h"
 
 using namespace std;
 
+extern const string DEFAULT_DATA_PATH;
+
+struct FreeSlot { // Result of Scheduler::findFreeSlot()
+    bool found;
+    int date;
+    Time startTime;
+    Time endTime;
+};
+
+/*
+ * The calendar and the changes made to it.
+ *
+ * The operations that change the calendar take turns on a mutex. After enableConcurrentReads() every change also
+ * publishes a copy of the calendar, which costs a pointer, and the next change clones a pointer per 32 days because
+ * the copy shares everything that was not changed. The views read the copy that was published last and never wait
+ * for a writer, so they may run on any number of threads while changes are made.
+ *
+ * Each change also keeps the days and the table of series it touched as they were before, which is enough to undo
+ * it and takes memory for what it touched only. Undo, redo and going back to a saved version
+ * are not journaled: they write the changed segments into the snapshot straight away.
+ */
 class Scheduler {
+public:
+    static const size_t UNDO_LIMIT = 1000; // steps kept for undo, the oldest is forgotten first
+
 private:
-    Day days[31];
-    int currentDay;
+    CalendarState state; // the working version, only touched by the writer
+    DayStore& days;
+    RecurrenceStore& rules;
+    atomic<bool> concurrentReads;
+    shared_ptr<const CalendarState> published; // read and replaced with atomic_load() and atomic_store()
+    mutex writerMutex;
+    int currentDay; // absolute day number of today, see Date::toDayNumber()
+    Journal journal; // changes made since the last snapshot
+    Snapshot snapshot; // the calendar as of the start of the journal
+    CalendarState::Change pendingStep; // what the change being made has touched so far
+    deque<CalendarState::Change> undoSteps; // oldest first, each holds only the days and series its change touched
+    deque<CalendarState::Change> redoSteps; // the steps that were undone, last undone at the back
+    map<string, CalendarState> savedVersions; // named versions of this session, each shares everything that has not changed since
+    bool readOnly; // loaded only to be looked at, nothing is written back
+    mutable mutex renderMutex; // the views take turns on the cache
+    mutable RenderCache renderCache; // text of the days and views drawn last
 
-    void initializeDays();
-    void saveEventsTo_txt();
-    void loadEventsFrom_txt();
-    void option_list(int index);
+    int lastDayOfMonth(int date) const;
+    Status addEventTo(int date, const Event& event);
+    void addSingleEvent(int date, Event& event);
+    void skipDaysOff(RecurrenceRule& rule) const;
+    RecurrenceRule& addRule(RecurrenceRule& rule);
+    void addSeriesLine(const TextLine& line, unordered_set<int>& legacySeries);
+    void printConflicts(const vector<Conflict>& conflicts) const;
+    shared_ptr<const CalendarState> readState() const; // the version that the views read
+    void publish();
+    Status syncJournal(); // fails only if the journal could not be written, a snapshot that cannot be written is reported and retried later
+    void writeSnapshot();
+    void startStep(); // record what the next change touches
+    void finishStep(bool changed); // keep the recorded step for undo if the change was made
+    Status saveStep(CalendarState::Change& step); // save the calendar after the step was reverted or restored, taking the step back if it cannot be saved
+    void keepStep(CalendarState::Change& step); // push the step on the undo history and forget the steps that could be redone
+
+    // The changes themselves, without prompts or output. Both the menu and the journal replay go through them.
+    // A rejected change leaves the calendar as it was and is reported as a Status, so replaying a journal never throws.
+    Expected<vector<Conflict>> applySchedule(int date, const Event& event, bool overrideDayOff); // stores nothing and returns the conflicts if there are any
+    Status applyCancel(int date, Title title, bool deleteRepeats);
+    Status applyShift(int date, Title title, int newDate);
+    void applySetDayOff(int date);
+    Status applyRecord(const JournalRecord& record);
+    void journalChange(const JournalRecord& record);
+    void option_list(int index, Renderer& frame) const;
 
 public:
-    Scheduler(int currentDay);
+    // dataPath names the files of the calendar without their extensions: dataPath.bin, dataPath.journal and dataPath.txt
+    Scheduler(int currentDay, const string& dataPath = DEFAULT_DATA_PATH, bool readOnly = false);
     ~Scheduler();
 
+    void saveEventsTo_txt(const string& path) const; // export in the text format
+    void loadEventsFrom_txt(const string& path); // import from the text format, call compact() afterwards to keep the import
+    vector<ImportConflict> bulkImportFrom_txt(const string& path, ThreadPool& pool); // parallel import that leaves out and reports the overlapping lines
+    void saveEventsTo_ics(const string& path) const; // export as an iCalendar file
+    vector<ImportConflict> importFrom_ics(const string& path); // import the events of an iCalendar file, leaving out and reporting the ones the calendar cannot hold
+    Status sync(); // write the journaled changes to the disk, folding them into the snapshot once the journal is long; fails if they are not durable
+    void compact(); // write the snapshot and empty the journal
+    void enableConcurrentReads(); // call before the views are used from other threads than the writer
+
+    // The operations without prompts or output, used by the menu below and by the batch mode.
+    // They check the dates against today and journal the change. The try functions return the error as a Status,
+    // which is cheap enough for bulk and automated scheduling where rejections are common, the others throw it.
+    Expected<vector<Conflict>> trySchedule(int date, const Event& event, bool overrideDayOff); // stores nothing and returns the conflicts if there are any
+    Status tryCancel(int date, const string& title, bool deleteRepeats);
+    Status tryShift(int date, const string& title, int newDate);
+    Status tryMarkDayOff(int date);
+    Status tryUndo();
+    Status tryRedo();
+    Status trySaveVersion(const string& name); // keep the calendar as it is now under the name, replacing a version with the same name
+    Status tryRestoreVersion(const string& name); // go back to a saved version, which can be undone like any other change
+    vector<string> savedVersionNames();
+    vector<Conflict> schedule(int date, const Event& event, bool overrideDayOff);
+    void cancel(int date, const string& title, bool deleteRepeats);
+    void shift(int date, const string& title, int newDate);
+    void markDayOff(int date);
+    Day daySchedule(int date) const; // the day with the occurrences of the series merged in
+
     void scheduleEvent(int date, Event& event);
     void cancelEvent(int date, string& title, bool deleteRepeats);
     void shiftEvent(int date, string& title, int newDate);
     void setDayOff(int date);
+    void undoChange();
+    void redoChange();
     void viewDaySchedule(int day) const;
     void viewWeekSchedule(int startDay) const;
-    void displayScheduler();
+    void displayScheduler(int date) const; // displays the month that contains the date
     bool isEventRepeating(int date, const string& title) const;
+    OccupancyBitmap busyMinutes(int date) const; // the minutes taken by the stored events and the series on the day, all of them on a day off
+    void viewStatistics() const; // counts and latencies of the operations since the program started, see Stats
+    // Earliest run of duration free minutes inside [windowStart, windowEnd) on a day in [firstDay, lastDay] that is not off
+    FreeSlot findFreeSlot(int duration, int firstDay, int lastDay, Time windowStart, Time windowEnd) const;
     void displayScheduler_print(int today);
-};
 
-string setColor(const string& txt, const int& color);
\ No newline at end of file
+    // The screens of the view functions composed into the frame. A screen whose days have not changed since it was
+    // drawn is copied from the render cache, otherwise only the changed days are formatted again.
+    void renderDaySchedule(int day, Renderer& frame) const;
+    void renderWeekSchedule(int startDay, Renderer& frame) const;
+    void renderMonthSchedule(int date, Renderer& frame) const;
+    void renderMonthCalendar(int today, Renderer& frame) const; // the calendar and the menu of displayScheduler_print()
+    uint64_t builtViews() const; // screens that were built rather than copied from the render cache
+};
\ No newline at end of file
@@ -1,23 +1,30 @@
 #include "SchedulerExceptions.h"
 
 SchedulerExceptions::SchedulerExceptions(int code) : Exceptions(code) { // Constructor for the SchedulerExceptions class
-	switch (errorCode) {
+	errorMessage = message(code);
+}
+
+const char* SchedulerExceptions::message(int code) {
+	switch (code) {
 	case 1:
-		errorMessage = "Invalid input. Please enter a valid date.";
-		break;
+		return "Invalid input. Please enter a valid date.";
 	case 2:
-		errorMessage = "The number entered is out of range.";
-		break;
+		return "The number entered is out of range.";
 	case 3:
-		errorMessage = "Invalid input. Please enter a valid option.";
-		break;
+		return "Invalid input. Please enter a valid option.";
 	case 4:
-		errorMessage = "Unable to open file for saving";
-		break;
+		return "Unable to open file for saving";
 	case 5:
-		errorMessage = "Unable to open file for loading";
-		break;
+		return "Unable to open file for loading";
+	case 6:
+		return "The snapshot file is damaged or was written by an unsupported version";
+	case 7:
+		return "There is no change to undo";
+	case 8:
+		return "There is no change to redo";
+	case 9:
+		return "There is no saved version with that name";
 	default:
-		errorMessage = "Scheduler error";
+		return "Scheduler error";
 	}
 }
\ No newline at end of file
@@ -5,4 +5,5 @@
 class SchedulerExceptions : public Exceptions { // Derived class for the SchedulerExceptions
 public:
 	SchedulerExceptions(int code);
+	static const char* message(int code);
 };
\ No newline at end of file
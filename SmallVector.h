@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+using namespace std;
+
+template <typename T, int InlineCapacity>
+class SmallVector { // Vector that keeps its first elements inside the object and only moves to the heap when it outgrows them
+private:
+    typename aligned_storage<sizeof(T) * InlineCapacity, alignof(T)>::type inlineBuffer;
+    T* elements;
+    int count;
+    int capacity;
+
+    T* inlineElements() { return reinterpret_cast<T*>(&inlineBuffer); }
+    bool isInline() const { return elements == reinterpret_cast<const T*>(&inlineBuffer); }
+
+    void releaseStorage() { // destroy the elements and give back the heap block if there is one
+        clear();
+        if (!isInline()) {
+            ::operator delete(elements);
+            elements = inlineElements();
+            capacity = InlineCapacity;
+        }
+    }
+
+    void takeFrom(SmallVector& other) { // steal a heap block, or move the elements one by one if they are inline
+        if (!other.isInline()) {
+            elements = other.elements;
+            capacity = other.capacity;
+            count = other.count;
+            other.elements = other.inlineElements();
+            other.capacity = InlineCapacity;
+            other.count = 0;
+            return;
+        }
+        for (int i = 0; i < other.count; ++i) {
+            new (elements + i) T(move(other.elements[i]));
+        }
+        count = other.count;
+        other.clear();
+    }
+
+public:
+    SmallVector() : elements(inlineElements()), count(0), capacity(InlineCapacity) {}
+
+    SmallVector(const SmallVector& other) : SmallVector() {
+        reserve(other.count);
+        for (int i = 0; i < other.count; ++i) {
+            new (elements + i) T(other.elements[i]);
+            ++count;
+        }
+    }
+
+    SmallVector(SmallVector&& other) noexcept : SmallVector() {
+        takeFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.count);
+            for (int i = 0; i < other.count; ++i) {
+                new (elements + i) T(other.elements[i]);
+                ++count;
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            releaseStorage();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        releaseStorage();
+    }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T& operator[](int index) { return elements[index]; }
+    const T& operator[](int index) const { return elements[index]; }
+
+    T* begin() { return elements; }
+    T* end() { return elements + count; }
+    const T* begin() const { return elements; }
+    const T* end() const { return elements + count; }
+
+    void reserve(int minimumCapacity) { // move the elements to a larger heap block, growing geometrically
+        if (minimumCapacity <= capacity) {
+            return;
+        }
+        int newCapacity = max(minimumCapacity, capacity * 2);
+        T* newElements = static_cast<T*>(::operator new(sizeof(T) * newCapacity));
+        for (int i = 0; i < count; ++i) {
+            new (newElements + i) T(move(elements[i]));
+            elements[i].~T();
+        }
+        if (!isInline()) {
+            ::operator delete(elements);
+        }
+        elements = newElements;
+        capacity = newCapacity;
+    }
+
+    void push_back(const T& value) {
+        insert(end(), value);
+    }
+
+    T* insert(T* position, const T& value) { // insert before the position and return the inserted element
+        int index = (int)(position - elements);
+        T copy = value; // the value may live inside this vector and move while it grows
+        reserve(count + 1);
+        if (index == count) {
+            new (elements + count) T(move(copy));
+        }
+        else {
+            new (elements + count) T(move(elements[count - 1]));
+            move_backward(elements + index, elements + count - 1, elements + count);
+            elements[index] = move(copy);
+        }
+        ++count;
+        return elements + index;
+    }
+
+    T* erase(T* position) { // remove the element and return the one that took its place
+        move(position + 1, end(), position);
+        elements[--count].~T();
+        return position;
+    }
+
+    void clear() {
+        for (int i = 0; i < count; ++i) {
+            elements[i].~T();
+        }
+        count = 0;
+    }
+};
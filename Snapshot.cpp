@@ -0,0 +1,350 @@
+#include "Snapshot.h"
+#include "SchedulerExceptions.h"
+#include "Platform.h"
+#include "OccupancyBitmap.h"
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+static const char SNAPSHOT_MAGIC[8] = { 'C', 'A', 'L', 'S', 'N', 'A', 'P', '\0' };
+static const size_t VERSION_1_HEADER_SIZE = 32;
+
+SnapshotView::SnapshotView(const char* data, size_t size) {
+    if (data == nullptr || size < VERSION_1_HEADER_SIZE) {
+        throw SchedulerExceptions(6);
+    }
+    header = reinterpret_cast<const SnapshotHeader*>(data);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header->version < 1 || header->version > SNAPSHOT_IMAGE_VERSION) {
+        throw SchedulerExceptions(6);
+    }
+    size_t headerSize = (header->version == 1) ? VERSION_1_HEADER_SIZE : sizeof(SnapshotHeader);
+    if (size < headerSize) {
+        throw SchedulerExceptions(6);
+    }
+    sequence = (header->version == 1) ? 0 : header->journalSequence;
+
+    size_t expectedSize = headerSize + (size_t)header->dayCount * sizeof(SnapshotDay) + (size_t)header->eventCount * sizeof(SnapshotEvent)
+        + (size_t)header->ruleCount * sizeof(SnapshotRule) + (size_t)header->exceptionCount * sizeof(int32_t) + header->stringTableSize;
+    if (expectedSize != size) {
+        throw SchedulerExceptions(6);
+    }
+
+    dayRecords = reinterpret_cast<const SnapshotDay*>(data + headerSize);
+    eventRecords = reinterpret_cast<const SnapshotEvent*>(dayRecords + header->dayCount);
+    ruleRecords = reinterpret_cast<const SnapshotRule*>(eventRecords + header->eventCount);
+    exceptionRecords = reinterpret_cast<const int32_t*>(ruleRecords + header->ruleCount);
+    strings = reinterpret_cast<const char*>(exceptionRecords + header->exceptionCount);
+
+    // Check every index once here so that readers can use the records without any further checks
+    auto validEvent = [this](const SnapshotEvent& event) {
+        return (size_t)event.titleOffset + event.titleLength <= this->header->stringTableSize && event.repeatType <= (uint8_t)RepeatType::Weekly
+            && event.startTime <= event.endTime && event.endTime < OccupancyBitmap::MINUTES_PER_DAY; // Time and Event would throw halfway through the load
+    };
+    for (uint32_t i = 0; i < header->eventCount; ++i) {
+        if (!validEvent(eventRecords[i])) throw SchedulerExceptions(6);
+    }
+    for (uint32_t i = 0; i < header->dayCount; ++i) {
+        const SnapshotDay& day = dayRecords[i];
+        if ((size_t)day.firstEvent + day.eventCount > header->eventCount || (i > 0 && day.date <= dayRecords[i - 1].date)) throw SchedulerExceptions(6);
+        for (uint32_t j = 1; j < day.eventCount; ++j) { // sorted as Day keeps them and apart, or Day::addEvent() would throw
+            const SnapshotEvent& previous = eventRecords[day.firstEvent + j - 1];
+            const SnapshotEvent& event = eventRecords[day.firstEvent + j];
+            bool sorted = previous.startTime < event.startTime || (previous.startTime == event.startTime && previous.endTime <= event.endTime);
+            bool overlaps = event.startTime < previous.endTime && event.endTime > previous.startTime;
+            if (!sorted || overlaps) throw SchedulerExceptions(6);
+        }
+    }
+    for (uint32_t i = 0; i < header->ruleCount; ++i) {
+        const SnapshotRule& rule = ruleRecords[i];
+        if (!validEvent(rule.event) || rule.period <= 0 || (size_t)rule.firstException + rule.exceptionCount > header->exceptionCount) {
+            throw SchedulerExceptions(6);
+        }
+    }
+}
+
+class ImageWriter { // Builds one image out of days and series
+private:
+    vector<SnapshotDay> dayRecords;
+    vector<SnapshotEvent> eventRecords;
+    vector<SnapshotRule> ruleRecords;
+    vector<int32_t> exceptionRecords;
+    string strings;
+    unordered_map<uint32_t, uint32_t> titleOffsets; // every title is stored once in the string table, keyed by its pool id
+
+    SnapshotEvent makeEvent(const Event& event) {
+        auto found = titleOffsets.find(event.title.getId());
+        if (found == titleOffsets.end()) {
+            found = titleOffsets.emplace(event.title.getId(), (uint32_t)strings.size()).first;
+            strings += event.title.view();
+        }
+        SnapshotEvent record = {};
+        record.titleOffset = found->second;
+        record.titleLength = (uint32_t)event.title.view().size();
+        record.startTime = (uint16_t)event.startTime.toMinutes();
+        record.endTime = (uint16_t)event.endTime.toMinutes();
+        record.repeatType = (uint8_t)event.repeatType;
+        return record;
+    }
+
+public:
+    void addDay(const Day& day) {
+        SnapshotDay record = {};
+        record.date = day.date;
+        record.firstEvent = (uint32_t)eventRecords.size();
+        record.eventCount = (uint32_t)day.events.size();
+        record.isDayOff = day.isDayOff ? 1 : 0;
+        for (const Event& event : day.events) {
+            eventRecords.push_back(makeEvent(event));
+        }
+        dayRecords.push_back(record);
+    }
+
+    void addRule(const RecurrenceRule& rule) {
+        SnapshotRule record = {};
+        record.event = makeEvent(rule.event);
+        record.firstDay = rule.firstDay;
+        record.lastDay = rule.lastDay;
+        record.period = rule.period;
+        record.firstException = (uint32_t)exceptionRecords.size();
+        record.exceptionCount = (uint32_t)rule.exceptions.size();
+        exceptionRecords.insert(exceptionRecords.end(), rule.exceptions.begin(), rule.exceptions.end());
+        ruleRecords.push_back(record);
+    }
+
+    void appendTo(string& output) const { // the image starts wherever the output ends
+        SnapshotHeader header = {};
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_IMAGE_VERSION;
+        header.dayCount = (uint32_t)dayRecords.size();
+        header.eventCount = (uint32_t)eventRecords.size();
+        header.ruleCount = (uint32_t)ruleRecords.size();
+        header.exceptionCount = (uint32_t)exceptionRecords.size();
+        header.stringTableSize = (uint32_t)strings.size();
+        header.journalSequence = 0; // kept in the file header
+
+        output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.append(reinterpret_cast<const char*>(dayRecords.data()), dayRecords.size() * sizeof(SnapshotDay));
+        output.append(reinterpret_cast<const char*>(eventRecords.data()), eventRecords.size() * sizeof(SnapshotEvent));
+        output.append(reinterpret_cast<const char*>(ruleRecords.data()), ruleRecords.size() * sizeof(SnapshotRule));
+        output.append(reinterpret_cast<const char*>(exceptionRecords.data()), exceptionRecords.size() * sizeof(int32_t));
+        output.append(strings);
+    }
+};
+
+static const size_t BLOCK_ALIGNMENT = 8;
+static const uint32_t DAY_BLOCK = 0;
+static const uint32_t RULE_BLOCK = 1;
+
+Snapshot::Snapshot(const string& path) {
+    this->path = path;
+    this->layoutKnown = false;
+    this->ruleBlock = {};
+    this->fileLength = 0;
+    this->indexOffset = 0;
+    this->liveBytes = 0;
+}
+
+void Snapshot::save(const DayStore& days, const RecurrenceStore& rules, uint32_t journalSequence) { // Append the changed blocks, or write the file from scratch
+    bool rewrite = !layoutKnown || fileLength > 2 * liveBytes; // a file that is mostly dead blocks is written again
+    uint64_t base = rewrite ? sizeof(SnapshotFileHeader) : fileLength; // where the appended part starts
+    string appended;
+    bool changed = rewrite;
+
+    auto appendBlock = [&appended, base](const ImageWriter& image, uint64_t version) {
+        appended.resize((appended.size() + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT, '\0'); // base is aligned as well
+        size_t start = appended.size();
+        image.appendTo(appended);
+        return Block{ base + start, appended.size() - start, version };
+    };
+
+    map<int, Block> newDayBlocks;
+    days.forEachSegment([&](int segmentNumber, const DayStore::Segment& segment) {
+        auto known = dayBlocks.find(segmentNumber);
+        if (!rewrite && known != dayBlocks.end() && known->second.version == segment.version) {
+            newDayBlocks.emplace(segmentNumber, known->second); // unchanged since it was written
+            return;
+        }
+        ImageWriter image;
+        for (auto it = segment.days.begin(); it != segment.days.end(); ++it) {
+            image.addDay(it->second);
+        }
+        newDayBlocks.emplace(segmentNumber, appendBlock(image, segment.version));
+        changed = true;
+    });
+    changed = changed || newDayBlocks.size() != dayBlocks.size(); // a segment that was emptied drops out of the index
+
+    Block newRuleBlock = ruleBlock;
+    if (rewrite || ruleBlock.version != rules.version()) {
+        ImageWriter image;
+        rules.forEach([&image](const RecurrenceRule& rule) { image.addRule(rule); });
+        newRuleBlock = appendBlock(image, rules.version());
+        changed = true;
+    }
+
+    SnapshotFileHeader header = {};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.journalSequence = journalSequence;
+    header.fileLength = fileLength;
+    header.indexOffset = indexOffset;
+    header.indexCount = (uint32_t)newDayBlocks.size() + 1;
+    uint64_t newLiveBytes = sizeof(SnapshotFileHeader) + newRuleBlock.size + header.indexCount * sizeof(SnapshotIndexEntry);
+    for (auto it = newDayBlocks.begin(); it != newDayBlocks.end(); ++it) {
+        newLiveBytes += it->second.size;
+    }
+    if (changed) { // the index of every live block goes behind the new blocks
+        vector<SnapshotIndexEntry> index;
+        index.reserve(newDayBlocks.size() + 1);
+        for (auto it = newDayBlocks.begin(); it != newDayBlocks.end(); ++it) {
+            index.push_back({ it->first, DAY_BLOCK, it->second.offset, it->second.size });
+        }
+        index.push_back({ 0, RULE_BLOCK, newRuleBlock.offset, newRuleBlock.size });
+        appended.resize((appended.size() + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT, '\0');
+        header.indexOffset = base + appended.size();
+        appended.append(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(SnapshotIndexEntry));
+        header.fileLength = base + appended.size();
+    } // otherwise only the journal sequence in the header moves
+
+    bool written;
+    if (rewrite) { // write the file next to the old one and swap it in, the old one stays in place until the new one is safely on the disk
+        string contents(reinterpret_cast<const char*>(&header), sizeof(header));
+        contents += appended;
+        string temporaryPath = path + ".tmp";
+        written = writeFileDurably(temporaryPath, contents) && replaceFile(temporaryPath, path);
+    }
+    else { // the blocks are on the disk before the header points at them, so a crash in between leaves the old snapshot intact
+        AppendFile file;
+        written = file.open(path) && file.truncate((size_t)fileLength) && file.write(appended.data(), appended.size()) && file.flushToDisk();
+        file.close();
+        written = written && writeFileHeadDurably(path, reinterpret_cast<const char*>(&header), sizeof(header)); // a single sector, written whole or not at all
+    }
+    if (!written) {
+        layoutKnown = false; // the file may be anything now, so the next save starts from scratch
+        throw SchedulerExceptions(4);
+    }
+
+    layoutKnown = true;
+    dayBlocks.swap(newDayBlocks);
+    ruleBlock = newRuleBlock;
+    fileLength = header.fileLength;
+    indexOffset = header.indexOffset;
+    liveBytes = newLiveBytes;
+}
+
+void Snapshot::loadImage(const SnapshotView& snapshot, DayStore& days, RecurrenceStore& rules) const {
+    auto makeEvent = [&snapshot](const SnapshotEvent& record) {
+        return Event(Title(snapshot.title(record)), Time::fromMinutes(record.startTime), Time::fromMinutes(record.endTime), (RepeatType)record.repeatType);
+    };
+
+    for (uint32_t i = 0; i < snapshot.dayCount(); ++i) {
+        const SnapshotDay& record = snapshot.day(i);
+        Day& day = days.getOrCreate(record.date);
+        day.events.reserve((int)record.eventCount);
+        for (uint32_t j = 0; j < record.eventCount; ++j) {
+            Event event = makeEvent(snapshot.event(record.firstEvent + j));
+            day.addEvent(event); // the events are stored sorted, so each one goes to the end of the day
+        }
+        day.isDayOff = record.isDayOff != 0;
+    }
+
+    for (uint32_t i = 0; i < snapshot.ruleCount(); ++i) {
+        const SnapshotRule& record = snapshot.rule(i);
+        RecurrenceRule rule(0, makeEvent(record.event), record.firstDay, record.lastDay);
+        rule.period = record.period;
+        for (uint32_t j = 0; j < record.exceptionCount; ++j) {
+            rule.exceptions.insert(snapshot.exception(record.firstException + j));
+        }
+        rules.add(rule);
+    }
+}
+
+uint32_t Snapshot::loadBlocks(const char* data, size_t size, DayStore& days, RecurrenceStore& rules) { // Check the file header and the index, then load every block
+    if (size < sizeof(SnapshotFileHeader)) {
+        throw SchedulerExceptions(6);
+    }
+    const SnapshotFileHeader* header = reinterpret_cast<const SnapshotFileHeader*>(data);
+    if (header->fileLength > size || header->indexOffset % BLOCK_ALIGNMENT != 0 || header->indexOffset < sizeof(SnapshotFileHeader)
+        || header->indexOffset > header->fileLength || (header->fileLength - header->indexOffset) / sizeof(SnapshotIndexEntry) < header->indexCount) {
+        throw SchedulerExceptions(6);
+    }
+    const SnapshotIndexEntry* index = reinterpret_cast<const SnapshotIndexEntry*>(data + header->indexOffset);
+
+    vector<SnapshotView> images;
+    images.reserve(header->indexCount);
+    map<int, Block> loadedDayBlocks;
+    Block loadedRuleBlock = {};
+    bool hasRuleBlock = false;
+    uint64_t loadedLiveBytes = sizeof(SnapshotFileHeader) + (uint64_t)header->indexCount * sizeof(SnapshotIndexEntry);
+    for (uint32_t i = 0; i < header->indexCount; ++i) {
+        const SnapshotIndexEntry& entry = index[i];
+        if (entry.offset % BLOCK_ALIGNMENT != 0 || entry.offset < sizeof(SnapshotFileHeader) || entry.offset > header->indexOffset || entry.size > header->indexOffset - entry.offset) {
+            throw SchedulerExceptions(6);
+        }
+        SnapshotView image(data + entry.offset, (size_t)entry.size);
+        if (entry.kind == DAY_BLOCK) {
+            if (image.ruleCount() != 0 || !loadedDayBlocks.emplace(entry.segment, Block{ entry.offset, entry.size, 0 }).second) {
+                throw SchedulerExceptions(6);
+            }
+            for (uint32_t j = 0; j < image.dayCount(); ++j) {
+                if (DayStore::segmentOf(image.day(j).date) != entry.segment) { // days may only be found through the block of their segment
+                    throw SchedulerExceptions(6);
+                }
+            }
+        }
+        else if (entry.kind == RULE_BLOCK && !hasRuleBlock && image.dayCount() == 0) {
+            loadedRuleBlock = { entry.offset, entry.size, 0 };
+            hasRuleBlock = true;
+        }
+        else {
+            throw SchedulerExceptions(6);
+        }
+        images.push_back(image);
+        loadedLiveBytes += entry.size;
+    }
+    if (!hasRuleBlock) {
+        throw SchedulerExceptions(6);
+    }
+    for (const SnapshotView& image : images) { // nothing is loaded before every block has been checked
+        loadImage(image, days, rules);
+    }
+
+    layoutKnown = true;
+    dayBlocks.swap(loadedDayBlocks);
+    ruleBlock = loadedRuleBlock;
+    fileLength = header->fileLength;
+    indexOffset = header->indexOffset;
+    liveBytes = loadedLiveBytes;
+    return header->journalSequence;
+}
+
+uint32_t Snapshot::load(DayStore& days, RecurrenceStore& rules) { // Map the snapshot and bulk-load its records
+    MappedFile file;
+    if (!file.open(path)) {
+        throw SchedulerExceptions(5);
+    }
+    layoutKnown = false;
+    uint32_t journalSequence;
+    if (file.size() >= sizeof(SnapshotFileHeader) && memcmp(file.begin(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0
+        && reinterpret_cast<const SnapshotFileHeader*>(file.begin())->version == SNAPSHOT_VERSION) {
+        journalSequence = loadBlocks(file.begin(), file.size(), days, rules);
+    }
+    else { // a single image from before version 3, the next save writes the file from scratch
+        SnapshotView snapshot(file.begin(), file.size());
+        loadImage(snapshot, days, rules);
+        journalSequence = snapshot.journalSequence();
+    }
+
+    if (layoutKnown) { // the blocks hold the stores as they are now, until the journal is replayed on top
+        days.forEachSegment([this](int segmentNumber, const DayStore::Segment& segment) {
+            auto block = dayBlocks.find(segmentNumber);
+            if (block != dayBlocks.end()) {
+                block->second.version = segment.version;
+            }
+        });
+        ruleBlock.version = rules.version();
+    }
+    return journalSequence;
+}
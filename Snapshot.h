@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include "DayStore.h"
+#include "RecurrenceStore.h"
+
+using namespace std;
+
+/*
+ * Binary snapshot of a calendar. The file is a header followed by blocks and an index of the blocks:
+ *
+ *     SnapshotFileHeader | block | block | ... | SnapshotIndexEntry[indexCount]
+ *
+ * Each block is a complete image of its own, the header followed by fixed-size records and a string table:
+ *
+ *     SnapshotHeader | SnapshotDay[dayCount] | SnapshotEvent[eventCount] | SnapshotRule[ruleCount]
+ *                    | int32_t exceptions[exceptionCount] | char strings[stringTableSize]
+ *
+ * A day block holds the days of one DayStore segment and the rule block holds every series. A save appends
+ * the blocks of the segments that changed and a new index behind the committed end of the file, and then
+ * rewrites the file header in place to point at them. Blocks that are no longer in the index are dropped the
+ * next time the file is written from scratch, which happens once they take up half of it.
+ *
+ * Records are stored in the byte order of the machine (little endian on every platform we build for) so
+ * that a mapped file can be read in place without parsing any field. Blocks start on 8 byte boundaries.
+ *
+ * Version 1 and 2 files are a single image without the file header and index, and are still loaded. Version 2
+ * added journalSequence to the image header; version 1 images have the 32 byte header without it.
+ */
+
+const uint32_t SNAPSHOT_VERSION = 3;
+const uint32_t SNAPSHOT_IMAGE_VERSION = 2; // the blocks, and the whole file before version 3
+
+struct SnapshotFileHeader {
+    char magic[8]; // "CALSNAP" followed by a null, as in the image header
+    uint32_t version;
+    uint32_t journalSequence; // the last journal record included in the snapshot
+    uint64_t fileLength; // committed length, anything behind it is left over from a save that did not finish
+    uint64_t indexOffset;
+    uint32_t indexCount;
+    uint32_t padding;
+};
+
+struct SnapshotIndexEntry {
+    int32_t segment; // DayStore segment number of a day block
+    uint32_t kind; // 0 for a day block, 1 for the rule block
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct SnapshotHeader { // header of an image
+    char magic[8]; // "CALSNAP" followed by a null
+    uint32_t version;
+    uint32_t dayCount;
+    uint32_t eventCount;
+    uint32_t ruleCount;
+    uint32_t exceptionCount;
+    uint32_t stringTableSize;
+    uint32_t journalSequence; // the last journal record included in the snapshot
+    uint32_t padding;
+};
+
+struct SnapshotEvent {
+    uint32_t titleOffset; // into the string table
+    uint32_t titleLength;
+    uint16_t startTime; // minutes since midnight
+    uint16_t endTime;
+    uint8_t repeatType;
+    uint8_t padding[3];
+};
+
+struct SnapshotDay {
+    int32_t date; // day number
+    uint32_t firstEvent; // index of the first event of the day, the events of a day are stored sorted and in one run
+    uint32_t eventCount;
+    uint8_t isDayOff;
+    uint8_t padding[3];
+};
+
+struct SnapshotRule {
+    SnapshotEvent event;
+    int32_t firstDay;
+    int32_t lastDay;
+    int32_t period;
+    uint32_t firstException; // index of the first cancelled date of the series
+    uint32_t exceptionCount;
+    uint32_t padding;
+};
+
+static_assert(sizeof(SnapshotHeader) == 40 && sizeof(SnapshotEvent) == 16 && sizeof(SnapshotDay) == 16 && sizeof(SnapshotRule) == 40, "snapshot records must keep their size");
+static_assert(sizeof(SnapshotFileHeader) == 40 && sizeof(SnapshotIndexEntry) == 24, "snapshot records must keep their size");
+
+class SnapshotView { // Checked, read-only access to the records of an image that lies in memory
+private:
+    const SnapshotHeader* header;
+    const SnapshotDay* dayRecords;
+    const SnapshotEvent* eventRecords;
+    const SnapshotRule* ruleRecords;
+    const int32_t* exceptionRecords;
+    const char* strings;
+    uint32_t sequence;
+
+public:
+    SnapshotView(const char* data, size_t size); // throws SchedulerExceptions(6) if the data is not a valid image
+
+    uint32_t journalSequence() const { return sequence; }
+    uint32_t dayCount() const { return header->dayCount; }
+    uint32_t ruleCount() const { return header->ruleCount; }
+    const SnapshotDay& day(uint32_t index) const { return dayRecords[index]; }
+    const SnapshotEvent& event(uint32_t index) const { return eventRecords[index]; }
+    const SnapshotRule& rule(uint32_t index) const { return ruleRecords[index]; }
+    int32_t exception(uint32_t index) const { return exceptionRecords[index]; }
+    string_view title(const SnapshotEvent& event) const { return string_view(strings + event.titleOffset, event.titleLength); }
+};
+
+class Snapshot { // Saves and loads the binary snapshot file, and remembers its layout to write only what changed
+private:
+    struct Block {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t version; // version of the segment or the rules that the block holds
+    };
+
+    string path;
+    bool layoutKnown; // false until the file has been loaded or written as version 3, the next save then writes it from scratch
+    map<int, Block> dayBlocks; // keyed by segment number
+    Block ruleBlock;
+    uint64_t fileLength;
+    uint64_t indexOffset;
+    uint64_t liveBytes; // the part of the file that the index still refers to
+
+    void loadImage(const SnapshotView& image, DayStore& days, RecurrenceStore& rules) const;
+    uint32_t loadBlocks(const char* data, size_t size, DayStore& days, RecurrenceStore& rules);
+
+public:
+    Snapshot(const string& path);
+
+    const string& getPath() const { return path; }
+    uint32_t load(DayStore& days, RecurrenceStore& rules); // returns the journal sequence of the snapshot
+    void save(const DayStore& days, const RecurrenceStore& rules, uint32_t journalSequence); // throws SchedulerExceptions(4) if the file cannot be written
+};
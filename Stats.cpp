@@ -0,0 +1,217 @@
+#include "Stats.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+using namespace std;
+
+static const int OPERATION_COUNT = (int)StatOperation::Count;
+static const char* const OPERATION_NAMES[OPERATION_COUNT] = { "schedule", "cancel", "shift", "dayOff", "loadText", "saveText", "bulkImport", "loadIcs", "saveIcs", "loadSnapshot", "saveSnapshot", "journalSync", "render" };
+
+const char* Stats::operationName(StatOperation operation) {
+    return OPERATION_NAMES[(int)operation];
+}
+
+static int highestBit(uint64_t value) { // floor(log2(value)) for a value above 0
+    int bit = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+        if (value >> shift) {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+}
+
+int Stats::bucketOf(uint64_t nanoseconds) {
+    if (nanoseconds < 8) {
+        return (int)nanoseconds;
+    }
+    int exponent = highestBit(nanoseconds);
+    if (exponent > 42) {
+        return BUCKET_COUNT - 1; // over an hour
+    }
+    return 4 * (exponent - 1) + (int)((nanoseconds >> (exponent - 2)) & 3);
+}
+
+uint64_t Stats::bucketLowerBound(int bucket) {
+    if (bucket < 8) {
+        return (uint64_t)bucket;
+    }
+    return (uint64_t)(4 + (bucket & 3)) << (bucket / 4 - 1);
+}
+
+uint64_t OperationStats::percentile(double fraction) const {
+    double nearest = ceil(fraction * count); // nearest rank, counted from 1
+    uint64_t rank = nearest > 1 ? (uint64_t)nearest - 1 : 0;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < (int)buckets.size(); ++bucket) {
+        seen += buckets[bucket];
+        if (seen > rank) {
+            uint64_t upper = (bucket + 1 < Stats::BUCKET_COUNT) ? Stats::bucketLowerBound(bucket + 1) - 1 : maxNanoseconds;
+            return upper < maxNanoseconds ? upper : maxNanoseconds;
+        }
+    }
+    return 0;
+}
+
+#ifndef CALENDAR_NO_STATS
+
+struct ThreadStats { // Written only by its own thread, read by collect() on any thread
+    atomic<uint64_t> buckets[OPERATION_COUNT][Stats::BUCKET_COUNT];
+    atomic<uint64_t> failures[OPERATION_COUNT];
+    atomic<uint64_t> totalNanoseconds[OPERATION_COUNT];
+    atomic<uint64_t> maxNanoseconds[OPERATION_COUNT];
+
+    ThreadStats() {
+        for (int operation = 0; operation < OPERATION_COUNT; ++operation) {
+            for (atomic<uint64_t>& bucket : buckets[operation]) {
+                bucket.store(0, memory_order_relaxed);
+            }
+            failures[operation].store(0, memory_order_relaxed);
+            totalNanoseconds[operation].store(0, memory_order_relaxed);
+            maxNanoseconds[operation].store(0, memory_order_relaxed);
+        }
+    }
+};
+
+static void bump(atomic<uint64_t>& counter, uint64_t amount) { // one writer, so a plain load and store is enough and needs no locked instruction
+    counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+struct StatsRegistry { // the threads that have recorded something, and the sums of the threads that have ended
+    mutex registryMutex;
+    vector<ThreadStats*> threads;
+    ThreadStats finished;
+};
+
+static StatsRegistry& registry() {
+    static StatsRegistry* instance = new StatsRegistry(); // never destroyed, threads may still end after main() returns
+    return *instance;
+}
+
+struct ThreadRegistration {
+    ThreadStats stats;
+
+    ThreadRegistration() {
+        StatsRegistry& shared = registry();
+        lock_guard<mutex> lock(shared.registryMutex);
+        shared.threads.push_back(&stats);
+    }
+    ~ThreadRegistration() { // the counts of the thread are kept after it ends
+        StatsRegistry& shared = registry();
+        lock_guard<mutex> lock(shared.registryMutex);
+        for (int operation = 0; operation < OPERATION_COUNT; ++operation) {
+            for (int bucket = 0; bucket < Stats::BUCKET_COUNT; ++bucket) {
+                bump(shared.finished.buckets[operation][bucket], stats.buckets[operation][bucket].load(memory_order_relaxed));
+            }
+            bump(shared.finished.failures[operation], stats.failures[operation].load(memory_order_relaxed));
+            bump(shared.finished.totalNanoseconds[operation], stats.totalNanoseconds[operation].load(memory_order_relaxed));
+            uint64_t longest = stats.maxNanoseconds[operation].load(memory_order_relaxed);
+            if (longest > shared.finished.maxNanoseconds[operation].load(memory_order_relaxed)) {
+                shared.finished.maxNanoseconds[operation].store(longest, memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < shared.threads.size(); ++i) {
+            if (shared.threads[i] == &stats) {
+                shared.threads.erase(shared.threads.begin() + i);
+                break;
+            }
+        }
+    }
+};
+
+void Stats::record(StatOperation operation, uint64_t nanoseconds, bool failed) {
+    static thread_local ThreadRegistration registration;
+    ThreadStats& stats = registration.stats;
+    int index = (int)operation;
+    bump(stats.buckets[index][bucketOf(nanoseconds)], 1);
+    bump(stats.totalNanoseconds[index], nanoseconds);
+    if (failed) {
+        bump(stats.failures[index], 1);
+    }
+    if (nanoseconds > stats.maxNanoseconds[index].load(memory_order_relaxed)) {
+        stats.maxNanoseconds[index].store(nanoseconds, memory_order_relaxed);
+    }
+}
+
+vector<OperationStats> Stats::collect() {
+    vector<OperationStats> operations(OPERATION_COUNT);
+    for (int operation = 0; operation < OPERATION_COUNT; ++operation) {
+        operations[operation] = { OPERATION_NAMES[operation], 0, 0, 0, 0, vector<uint64_t>(BUCKET_COUNT) };
+    }
+
+    StatsRegistry& shared = registry();
+    lock_guard<mutex> lock(shared.registryMutex);
+    auto add = [&operations](const ThreadStats& stats) {
+        for (int operation = 0; operation < OPERATION_COUNT; ++operation) {
+            OperationStats& sum = operations[operation];
+            for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+                uint64_t count = stats.buckets[operation][bucket].load(memory_order_relaxed);
+                sum.buckets[bucket] += count;
+                sum.count += count;
+            }
+            sum.failures += stats.failures[operation].load(memory_order_relaxed);
+            sum.totalNanoseconds += stats.totalNanoseconds[operation].load(memory_order_relaxed);
+            uint64_t longest = stats.maxNanoseconds[operation].load(memory_order_relaxed);
+            sum.maxNanoseconds = longest > sum.maxNanoseconds ? longest : sum.maxNanoseconds;
+        }
+    };
+    add(shared.finished);
+    for (const ThreadStats* stats : shared.threads) {
+        add(*stats);
+    }
+    return operations;
+}
+
+#else
+
+vector<OperationStats> Stats::collect() {
+    return {};
+}
+
+#endif
+
+string Stats::formatLines() {
+    string lines;
+    char line[256];
+    for (const OperationStats& operation : collect()) {
+        snprintf(line, sizeof(line), "%s|%llu|%llu|%llu|%llu|%llu|%llu|%llu\n", operation.name.c_str(), (unsigned long long)operation.count, (unsigned long long)operation.failures,
+            (unsigned long long)(operation.count > 0 ? operation.totalNanoseconds / operation.count : 0), (unsigned long long)operation.percentile(0.5),
+            (unsigned long long)operation.percentile(0.9), (unsigned long long)operation.percentile(0.99), (unsigned long long)operation.maxNanoseconds);
+        lines += line;
+    }
+    return lines;
+}
+
+string Stats::toJson() {
+    string json = "{\n  \"operations\": [";
+    char fields[256];
+    bool first = true;
+    for (const OperationStats& operation : collect()) {
+        snprintf(fields, sizeof(fields), "\"count\": %llu, \"failures\": %llu, \"totalNs\": %llu, \"p50Ns\": %llu, \"p90Ns\": %llu, \"p99Ns\": %llu, \"maxNs\": %llu",
+            (unsigned long long)operation.count, (unsigned long long)operation.failures, (unsigned long long)operation.totalNanoseconds, (unsigned long long)operation.percentile(0.5),
+            (unsigned long long)operation.percentile(0.9), (unsigned long long)operation.percentile(0.99), (unsigned long long)operation.maxNanoseconds);
+        json += first ? "\n    " : ",\n    ";
+        json += "{\"name\": \"" + operation.name + "\", " + fields + ", \"buckets\": [";
+        bool firstBucket = true;
+        for (int bucket = 0; bucket < (int)operation.buckets.size(); ++bucket) {
+            if (operation.buckets[bucket] != 0) {
+                json += (firstBucket ? "[" : ", [") + to_string(bucketLowerBound(bucket)) + ", " + to_string(operation.buckets[bucket]) + "]";
+                firstBucket = false;
+            }
+        }
+        json += "]}";
+        first = false;
+    }
+    return json + "\n  ]\n}\n";
+}
+
+bool Stats::writeJson(const string& path) {
+    ofstream file(path);
+    file << toJson();
+    return (bool)file;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Counters and latency histograms of the calendar operations, kept per thread so that recording takes no lock
+ * and shares no cache line with other threads. collect() adds up the threads when the numbers are asked for.
+ *
+ * Defining CALENDAR_NO_STATS leaves all of it out: StatsTimer is then empty and collect() returns nothing.
+ */
+
+enum class StatOperation : uint8_t { Schedule, Cancel, Shift, DayOff, LoadText, SaveText, BulkImport, LoadIcs, SaveIcs, LoadSnapshot, SaveSnapshot, JournalSync, Render, Count };
+
+struct OperationStats { // one operation, added up over every thread
+    string name;
+    uint64_t count;
+    uint64_t failures; // rejected or thrown, these are timed as well
+    uint64_t totalNanoseconds;
+    uint64_t maxNanoseconds;
+    vector<uint64_t> buckets; // latency histogram, see Stats::bucketLowerBound()
+
+    uint64_t percentile(double fraction) const; // upper end of the bucket that holds the percentile, 0 without any count
+};
+
+class Stats {
+public:
+    // Four buckets for every power of two of the nanoseconds, so that a bucket is at most 25% wide
+    static const int BUCKET_COUNT = 168;
+
+#ifdef CALENDAR_NO_STATS
+    static constexpr bool enabled = false;
+    static void record(StatOperation, uint64_t, bool) {}
+#else
+    static constexpr bool enabled = true;
+    static void record(StatOperation operation, uint64_t nanoseconds, bool failed);
+#endif
+
+    static const char* operationName(StatOperation operation);
+    static int bucketOf(uint64_t nanoseconds);
+    static uint64_t bucketLowerBound(int bucket);
+
+    static vector<OperationStats> collect(); // every operation, in the order of StatOperation
+
+    static string formatLines(); // one name|count|failures|meanNs|p50Ns|p90Ns|p99Ns|maxNs line per operation
+    static string toJson(); // the same with the non-empty buckets as [lowerBoundNs, count] pairs
+    static bool writeJson(const string& path);
+};
+
+#ifdef CALENDAR_NO_STATS
+
+class StatsTimer {
+public:
+    explicit StatsTimer(StatOperation) {}
+    void fail(bool = true) {}
+};
+
+#else
+
+class StatsTimer { // Times its own lifetime as one operation; leaving by an exception counts as a failure
+private:
+    StatOperation operation;
+    chrono::steady_clock::time_point started;
+    int exceptions;
+    bool failed;
+
+public:
+    explicit StatsTimer(StatOperation operation) : operation(operation), started(chrono::steady_clock::now()), exceptions(uncaught_exceptions()), failed(false) {}
+    ~StatsTimer() {
+        uint64_t elapsed = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - started).count();
+        Stats::record(operation, elapsed, failed || uncaught_exceptions() > exceptions);
+    }
+    StatsTimer(const StatsTimer&) = delete;
+    StatsTimer& operator=(const StatsTimer&) = delete;
+
+    void fail(bool failed = true) { this->failed = failed; }
+};
+
+#endif
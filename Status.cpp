@@ -0,0 +1,38 @@
+#include "Status.h"
+#include "EventExceptions.h"
+#include "DayExceptions.h"
+#include "TimeExceptions.h"
+#include "DateExceptions.h"
+#include "SchedulerExceptions.h"
+
+const char* Status::message() const {
+    switch (kind) {
+    case ErrorKind::Event:
+        return EventExceptions::message(code);
+    case ErrorKind::Day:
+        return DayExceptions::message(code);
+    case ErrorKind::Time:
+        return TimeExceptions::message(code);
+    case ErrorKind::Date:
+        return DateExceptions::message(code);
+    case ErrorKind::Scheduler:
+        return SchedulerExceptions::message(code);
+    default:
+        return "";
+    }
+}
+
+void Status::raise() const {
+    switch (kind) {
+    case ErrorKind::Event:
+        throw EventExceptions(code);
+    case ErrorKind::Day:
+        throw DayExceptions(code);
+    case ErrorKind::Time:
+        throw TimeExceptions(code);
+    case ErrorKind::Date:
+        throw DateExceptions(code);
+    default:
+        throw SchedulerExceptions(code);
+    }
+}
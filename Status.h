@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+using namespace std;
+
+enum class ErrorKind : uint8_t { None, Event, Day, Time, Date, Scheduler }; // which *Exceptions class the code belongs to
+
+/*
+ * Outcome of an operation that reports its errors without throwing.
+ *
+ * The codes are those of the matching *Exceptions class and share its messages, so a Status can always be
+ * turned back into the exception that the throwing functions raise. Making or copying a Status allocates nothing.
+ */
+class Status {
+private:
+    ErrorKind kind;
+    int code;
+
+public:
+    constexpr Status(ErrorKind kind = ErrorKind::None, int code = 0) : kind(kind), code(code) {}
+
+    bool isOk() const { return kind == ErrorKind::None; }
+    ErrorKind getKind() const { return kind; }
+    int getCode() const { return code; }
+    bool is(ErrorKind kind, int code) const { return this->kind == kind && this->code == code; }
+
+    const char* message() const; // the text that what() of the matching exception returns
+    [[noreturn]] void raise() const; // throw the matching exception
+    void throwIfError() const {
+        if (!isOk()) {
+            raise();
+        }
+    }
+};
+
+template <typename T>
+class Expected { // A value, or the Status that explains why there is none
+private:
+    T value;
+    Status status;
+
+public:
+    Expected(T value) : value(move(value)) {}
+    Expected(Status status) : value(), status(status) {}
+
+    bool hasValue() const { return status.isOk(); }
+    const Status& error() const { return status; }
+
+    T& operator*() { return value; }
+    const T& operator*() const { return value; }
+    const T* operator->() const { return &value; }
+
+    T valueOrThrow() && { // for the throwing wrappers
+        status.throwIfError();
+        return move(value);
+    }
+};
@@ -0,0 +1,111 @@
+#include "StringPool.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+StringPool::StringPool() {
+    this->arenaUsed = ARENA_BLOCK_SIZE; // the first title starts a block
+    this->count = 0;
+    intern(string_view()); // id 0 is the empty title
+    intern("EVENT"); // DEFAULT_TITLE_ID
+}
+
+StringPool& StringPool::shared() {
+    static StringPool pool;
+    return pool;
+}
+
+const char* StringPool::copyToArena(string_view text) {
+    if (text.empty()) {
+        return "";
+    }
+    if (text.size() > ARENA_BLOCK_SIZE / 4) { // a long title gets a block of its own, in front of the block that is being filled
+        unique_ptr<char[]> block(new char[text.size()]);
+        memcpy(block.get(), text.data(), text.size());
+        const char* copy = block.get();
+        arena.insert(arena.empty() ? arena.end() : arena.end() - 1, move(block));
+        return copy;
+    }
+    if (text.size() > ARENA_BLOCK_SIZE - arenaUsed) {
+        arena.emplace_back(new char[ARENA_BLOCK_SIZE]);
+        arenaUsed = 0;
+    }
+    char* copy = arena.back().get() + arenaUsed;
+    memcpy(copy, text.data(), text.size());
+    arenaUsed += text.size();
+    return copy;
+}
+
+uint32_t StringPool::intern(string_view text) {
+    lock_guard<mutex> lock(poolMutex);
+    return internLocked(text);
+}
+
+void StringPool::internAll(const vector<string_view>& texts, vector<uint32_t>& textIds) {
+    textIds.resize(texts.size());
+    lock_guard<mutex> lock(poolMutex);
+    for (size_t i = 0; i < texts.size(); ++i) {
+        textIds[i] = internLocked(texts[i]);
+    }
+}
+
+uint32_t StringPool::internLocked(string_view text) {
+    auto found = ids.find(text);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    if (count == MAX_ID_BLOCKS * IDS_PER_BLOCK) {
+        throw length_error("Too many distinct titles");
+    }
+
+    string_view stored(copyToArena(text), text.size());
+    uint32_t id = count;
+    if (id % IDS_PER_BLOCK == 0) {
+        textBlocks[id / IDS_PER_BLOCK].reset(new string_view[IDS_PER_BLOCK]);
+    }
+    textBlocks[id / IDS_PER_BLOCK][id % IDS_PER_BLOCK] = stored;
+    ids.emplace(stored, id);
+    ++count;
+    return id;
+}
+
+bool StringPool::find(string_view text, uint32_t& id) const {
+    lock_guard<mutex> lock(poolMutex);
+    auto found = ids.find(text);
+    if (found == ids.end()) {
+        return false;
+    }
+    id = found->second;
+    return true;
+}
+
+int StringPool::size() const {
+    lock_guard<mutex> lock(poolMutex);
+    return (int)count;
+}
+
+Title::Title(string_view text) {
+    this->id = text.empty() ? 0 : StringPool::shared().intern(text);
+}
+
+Title Title::defaultTitle() {
+    Title title;
+    title.id = StringPool::DEFAULT_TITLE_ID;
+    return title;
+}
+
+vector<Title> Title::makeAll(const vector<string_view>& texts) {
+    vector<uint32_t> ids;
+    StringPool::shared().internAll(texts, ids);
+    vector<Title> titles(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        titles[i].id = ids[i];
+    }
+    return titles;
+}
+
+bool Title::find(string_view text, Title& title) {
+    return StringPool::shared().find(text, title.id);
+}
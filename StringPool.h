@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Pool that keeps one copy of every distinct title for the whole program.
+ *
+ * The characters are copied into large arena blocks that never move, so a title handed out stays valid until
+ * the program ends, and each title is looked up by a small id. Interning takes a lock, so the threads of a bulk
+ * import can share the pool, while looking up the text of an id does not. A thread with many titles interns them
+ * with internAll() under a single lock rather than taking turns on it for each one.
+ */
+class StringPool {
+private:
+    static const size_t ARENA_BLOCK_SIZE = 1 << 16; // titles longer than this get a block of their own
+    static const uint32_t IDS_PER_BLOCK = 1 << 12;
+    static const uint32_t MAX_ID_BLOCKS = 1 << 14; // room for 64M distinct titles
+
+    mutable mutex poolMutex;
+    vector<unique_ptr<char[]>> arena;
+    size_t arenaUsed; // characters used in the last arena block
+    unordered_map<string_view, uint32_t> ids; // the views point into the arena
+    unique_ptr<string_view[]> textBlocks[MAX_ID_BLOCKS]; // text of each id, the blocks never move so readers need no lock
+    uint32_t count;
+
+    StringPool();
+    const char* copyToArena(string_view text);
+    uint32_t internLocked(string_view text); // intern() with the lock already held
+
+public:
+    static const uint32_t DEFAULT_TITLE_ID = 1; // "EVENT", interned when the pool is made so the default title takes no lock
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    static StringPool& shared();
+
+    uint32_t intern(string_view text); // the id of the text, adding it the first time it is seen
+    void internAll(const vector<string_view>& texts, vector<uint32_t>& textIds); // the id of each text, under one lock
+    bool find(string_view text, uint32_t& id) const; // false if the text was never interned
+    string_view text(uint32_t id) const { return textBlocks[id / IDS_PER_BLOCK][id % IDS_PER_BLOCK]; }
+    int size() const;
+};
+
+class Title { // Title of an event, held as the id of its text in the shared pool so that copies and comparisons are cheap
+private:
+    uint32_t id;
+
+public:
+    Title(string_view text = string_view());
+    Title(const string& text) : Title(string_view(text)) {}
+    Title(const char* text) : Title(string_view(text)) {}
+
+    static Title defaultTitle(); // "EVENT", without a lookup in the pool
+    static vector<Title> makeAll(const vector<string_view>& texts); // a title for each text, interned under one lock
+    static bool find(string_view text, Title& title); // false if no title was ever made from the text, without adding it to the pool
+
+    uint32_t getId() const { return id; }
+    string_view view() const { return StringPool::shared().text(id); }
+    string toString() const { return string(view()); }
+    bool empty() const { return view().empty(); }
+
+    bool operator==(const Title& other) const { return id == other.id; }
+    bool operator!=(const Title& other) const { return id != other.id; }
+};
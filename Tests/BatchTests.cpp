@@ -0,0 +1,109 @@
+#include "Tests.h"
+#include "../CommandProcessor.h"
+#include "../Scheduler.h"
+
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+// Every command and every kind of answer, as run by --batch
+static const char* BATCH =
+    "# a week of changes\n"
+    "schedule|2030-01-07|Standup|09:00|09:15|daily\n"
+    "schedule|2030-01-08|Review|14:00|15:00|weekly\n"
+    "schedule|2030-01-09|Lunch|12:00|13:00|none\n"
+    "schedule|2030-01-09|Overlap|12:30|13:30|none\n"
+    "schedule|2030-02-30|Bad|10:00|11:00|none\n"
+    "schedule|2030-01-09|Backwards|11:00|10:00|none\n"
+    "view|2030-01-09\n"
+    "cancel|2030-01-10|Standup\n"
+    "view|2030-01-10\n"
+    "shift|2030-01-09|Lunch|2030-01-11\n"
+    "shift|2030-01-11|Lunch|2030-01-08\n"
+    "cancel|2030-01-09|Missing\n"
+    "dayoff|2030-01-12\n"
+    "schedule|2030-01-12|Hike|08:00|12:00|none\n"
+    "schedule|2030-01-12|Hike|10:00|12:00|none|override\n"
+    "view|2030-01-12\n"
+    "free|60|2030-01-08|2030-01-08|09:00|17:00\n"
+    "free|600|2030-01-08|2030-01-08|09:00|17:00\n"
+    "version|before\n"
+    "cancel|2030-01-15|Review|all\n"
+    "view|2030-01-22\n"
+    "undo\n"
+    "view|2030-01-22\n"
+    "redo\n"
+    "view|2030-01-22\n"
+    "restore|before\n"
+    "view|2030-01-22\n"
+    "restore|unknown\n"
+    "versions\n"
+    "undo\n"
+    "undo\n"
+    "view|2030-01-12\n"
+    "sync\n"
+    "frobnicate|2030-01-01\n";
+
+static const char* ANSWERS =
+    "OK\n"
+    "OK\n"
+    "OK\n"
+    "ERR Line 5: Event overlaps with an existing event (Lunch on 2030-01-09)\n"
+    "ERR Line 6, column 10: Invalid date, expected YYYY-MM-DD\n"
+    "ERR Line 7: Event end time must be after start time\n"
+    "OK 2\n2030-01-09|Standup|09:00|09:15|daily\n2030-01-09|Lunch|12:00|13:00|none\n"
+    "OK\n"
+    "OK 0\n"
+    "OK\n"
+    "OK\n"
+    "ERR Line 13: No such event exists\n"
+    "OK\n"
+    "ERR Line 15: Cannot schedule events on a day off\n"
+    "OK\n"
+    "OK 1\n2030-01-12|Hike|10:00|12:00|none\n"
+    "OK 2030-01-08|09:15|10:15\n"
+    "OK none\n"
+    "OK\n"
+    "OK\n"
+    "OK 1\n2030-01-22|Standup|09:00|09:15|daily\n"
+    "OK\n"
+    "OK 2\n2030-01-22|Standup|09:00|09:15|daily\n2030-01-22|Review|14:00|15:00|weekly\n"
+    "OK\n"
+    "OK 1\n2030-01-22|Standup|09:00|09:15|daily\n"
+    "OK\n"
+    "OK 2\n2030-01-22|Standup|09:00|09:15|daily\n2030-01-22|Review|14:00|15:00|weekly\n"
+    "ERR Line 29: There is no saved version with that name\n"
+    "OK 1\nbefore\n"
+    "OK\n"
+    "OK\n"
+    "OK 1\n2030-01-12|Hike|10:00|12:00|none\n"
+    "OK\n"
+    "ERR Line 35, column 1: Unknown command\n";
+
+static const char* EXPORTED =
+    "2030-01-08|Lunch|12:00|13:00|none\n"
+    "2030-01-12|Hike|10:00|12:00|none\n"
+    "2030-01-07|Standup|09:00|09:15|daily||2030-01-10,2030-01-12\n"
+    "2030-01-08|Review|14:00|15:00|weekly||\n";
+
+void runBatchTests(TestRunner& runner) {
+    runner.run("CommandProcessor, a text batch gives the same answers and calendar as before", [](TestRunner& runner) {
+        string path = runner.dataPath("batch");
+        string textPath = runner.scratchPath("batch-export.txt");
+        {
+            Scheduler scheduler(numeric_limits<int>::min(), path);
+            CommandProcessor processor(scheduler);
+            istringstream commands(BATCH);
+            ostringstream answers;
+            processor.run(commands, answers);
+            CHECK(runner, answers.str() == ANSWERS);
+            scheduler.saveEventsTo_txt(textPath);
+            CHECK(runner, readFile(textPath) == EXPORTED);
+        }
+
+        Scheduler reloaded(numeric_limits<int>::min(), path, true); // the journal holds the same calendar
+        reloaded.saveEventsTo_txt(textPath);
+        CHECK(runner, readFile(textPath) == EXPORTED);
+    });
+}
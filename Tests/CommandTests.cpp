@@ -0,0 +1,42 @@
+#include "Tests.h"
+#include "../Scheduler.h"
+
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+void runCommandTests(TestRunner& runner) {
+    runner.run("Scheduler, a calendar with no files writes nothing to the standard output", [](TestRunner& runner) {
+        string path = runner.scratchPath("fresh"); // no .txt either, so loading fails
+        runner.scratchPath("fresh.bin");
+        runner.scratchPath("fresh.journal");
+        ostringstream output;
+        streambuf* standardOutput = cout.rdbuf(output.rdbuf()); // the answers of --batch and --serve go to the standard output
+        {
+            Scheduler scheduler(numeric_limits<int>::min(), path);
+            runCommands(scheduler, "schedule|2030-01-01|Meeting|09:00|10:00|none\nsync\n");
+        }
+        cout.rdbuf(standardOutput);
+        CHECK(runner, output.str().empty());
+    });
+
+#ifndef _WIN32 // /dev/full fails every write
+    runner.run("CommandProcessor, changes whose journal write fails are answered PENDING", [](TestRunner& runner) {
+        string path = runner.dataPath("pending");
+        string journalPath = path + ".journal";
+        CHECK(runner, symlink("/dev/full", journalPath.c_str()) == 0);
+        Scheduler scheduler(numeric_limits<int>::min(), path);
+
+        string answers = runCommands(scheduler, "schedule|2030-01-01|Meeting|09:00|10:00|none\ndayoff|2030-01-02\ncancel|2030-01-03|Meeting\nsync\n");
+        CHECK(runner, answers == "PENDING Line 1: Unable to open file for saving\nPENDING Line 2: Unable to open file for saving\n"
+            "ERR Line 3: No such event exists\nERR Line 4: Unable to open file for saving\n");
+        CHECK(runner, runCommands(scheduler, "view|2030-01-01\n") == "OK 1\n2030-01-01|Meeting|09:00|10:00|none\n"); // the change is still made
+    });
+#endif
+}
@@ -0,0 +1,84 @@
+#include "Tests.h"
+#include "../Scheduler.h"
+#include "../Date.h"
+#include "../Renderer.h"
+
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static const int READER_THREADS = 4;
+static const int WRITER_ROUNDS = 2000; // each round schedules and cancels one event, and every tenth a series as well
+static const int MINIMUM_READS = 1000; // the writer goes on until the readers have read this much, however the threads are scheduled
+
+static bool isConsistent(const Day& day) { // the standup is always there, and the events are sorted and do not overlap
+    if (day.events.empty() || day.events.size() > 3 || day.events[0].title.toString() != "Standup") {
+        return false;
+    }
+    for (int i = 1; i < day.events.size(); ++i) {
+        if (day.events[i].startTime < day.events[i - 1].endTime) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void runConcurrencyTests(TestRunner& runner) {
+    runner.run("Scheduler, readers see whole versions while a writer changes the calendar", [](TestRunner& runner) {
+        int firstDay = Date(2030, 1, 1).toDayNumber();
+        Scheduler scheduler(numeric_limits<int>::min(), runner.dataPath("readers"));
+        CHECK(runner, runCommands(scheduler, "schedule|2030-01-01|Standup|09:00|09:15|daily\n") == "OK\n");
+        scheduler.enableConcurrentReads();
+
+        atomic<bool> writing(true);
+        atomic<int> reads(0);
+        atomic<int> inconsistentDays(0);
+        atomic<int> emptyViews(0);
+        vector<thread> readers;
+        for (int reader = 0; reader < READER_THREADS; ++reader) {
+            readers.emplace_back([&, reader]() {
+                for (int read = reader; writing.load(memory_order_relaxed); ++read) {
+                    int date = firstDay + read % 14;
+                    if (!isConsistent(scheduler.daySchedule(date))) {
+                        ++inconsistentDays;
+                    }
+                    Renderer frame;
+                    switch (read % 3) {
+                    case 0: scheduler.renderDaySchedule(date, frame); break;
+                    case 1: scheduler.renderWeekSchedule(date, frame); break;
+                    default: scheduler.renderMonthSchedule(date, frame); break;
+                    }
+                    if (frame.text().empty()) {
+                        ++emptyViews;
+                    }
+                    ++reads;
+                }
+            });
+        }
+
+        Event late(Title("Late"), Time(20, 0), Time(21, 0), RepeatType::None);
+        Event review(Title("Review"), Time(14, 0), Time(15, 0), RepeatType::Weekly);
+        int failedWrites = 0;
+        for (int round = 0; round < WRITER_ROUNDS || reads.load() < MINIMUM_READS; ++round) {
+            int date = firstDay + round % 14;
+            Expected<vector<Conflict>> scheduled = scheduler.trySchedule(date, late, false);
+            failedWrites += (!scheduled.hasValue() || !scheduled->empty() || !scheduler.tryCancel(date, "Late", false).isOk()) ? 1 : 0;
+            if (round % 10 == 0) {
+                scheduled = scheduler.trySchedule(date, review, false);
+                failedWrites += (!scheduled.hasValue() || !scheduled->empty() || !scheduler.tryCancel(date, "Review", true).isOk()) ? 1 : 0;
+            }
+        }
+        writing = false;
+        for (thread& reader : readers) {
+            reader.join();
+        }
+
+        CHECK(runner, failedWrites == 0);
+        CHECK(runner, inconsistentDays.load() == 0);
+        CHECK(runner, emptyViews.load() == 0);
+        CHECK(runner, runCommands(scheduler, "view|2030-01-05\n") == "OK 1\n2030-01-05|Standup|09:00|09:15|daily\n");
+    });
+}
@@ -0,0 +1,36 @@
+#include "Tests.h"
+#include "../Scheduler.h"
+#include "../Date.h"
+#include "../DateExceptions.h"
+
+#include <limits>
+
+using namespace std;
+
+void runDateTests(TestRunner& runner) {
+    runner.run("Date, years outside 1 to 9999 are invalid", [](TestRunner& runner) {
+        Date date;
+        CHECK(runner, Date::tryParse("0001-01-01", date) && date.toDayNumber() == -719162);
+        CHECK(runner, Date::tryParse("9999-12-31", date) && date.toDayNumber() == 2932896);
+        CHECK(runner, Date::fromDayNumber(2932896).toString() == "9999-12-31");
+        CHECK(runner, !Date::tryParse("0000-12-31", date));
+        CHECK(runner, !Date::tryParse("10000-01-01", date));
+        CHECK(runner, !Date::tryParse("-5-01-01", date));
+        CHECK(runner, !Date::tryParse("2000000000-01-01", date)); // its day number does not fit in an int
+
+        bool thrown = false;
+        try {
+            Date(2000000000, 1, 1);
+        }
+        catch (const DateExceptions& exception) {
+            thrown = (string(exception.what()) == DateExceptions::message(1));
+        }
+        CHECK(runner, thrown);
+    });
+
+    runner.run("Date, a command with a year out of range is rejected", [](TestRunner& runner) {
+        Scheduler scheduler(numeric_limits<int>::min(), runner.dataPath("date-range"));
+        CHECK(runner, runCommands(scheduler, "schedule|2000000000-01-01|Meeting|09:00|10:00|none\n").compare(0, 22, "ERR Line 1, column 10:") == 0);
+        CHECK(runner, runCommands(scheduler, "schedule|9999-12-31|Meeting|09:00|10:00|none\nview|9999-12-31\n") == "OK\nOK 1\n9999-12-31|Meeting|09:00|10:00|none\n");
+    });
+}
@@ -0,0 +1,30 @@
+#include "Tests.h"
+#include "../Scheduler.h"
+#include "../Date.h"
+#include "../ThreadPool.h"
+
+#include <fstream>
+#include <limits>
+
+using namespace std;
+
+void runImportTests(TestRunner& runner) {
+    runner.run("BulkImporter, a day off cancels the occurrences of a stored series", [](TestRunner& runner) {
+        Scheduler scheduler(numeric_limits<int>::min(), runner.dataPath("bulk-day-off"));
+        CHECK(runner, runCommands(scheduler, "schedule|2030-01-01|Standup|09:00|09:15|daily\n") == "OK\n");
+
+        string importPath = runner.scratchPath("bulk-day-off-import.txt");
+        ofstream(importPath) << "2030-01-03|off|\n";
+        ThreadPool pool(2);
+        CHECK(runner, scheduler.bulkImportFrom_txt(importPath, pool).empty());
+
+        Day day = scheduler.daySchedule(Date(2030, 1, 3).toDayNumber());
+        CHECK(runner, day.isDayOff);
+        CHECK(runner, day.events.empty());
+        CHECK(runner, runCommands(scheduler, "view|2030-01-03\nview|2030-01-04\n") == "OK 1\n2030-01-03|off|\nOK 1\n2030-01-04|Standup|09:00|09:15|daily\n");
+
+        string exportPath = runner.scratchPath("bulk-day-off-export.txt");
+        scheduler.saveEventsTo_txt(exportPath);
+        CHECK(runner, readFile(exportPath).find("2030-01-01|Standup|09:00|09:15|daily||2030-01-03") != string::npos); // the cancelled date is kept
+    });
+}
@@ -0,0 +1,107 @@
+#include "Tests.h"
+#include "../Scheduler.h"
+#include "../Date.h"
+#include "../Renderer.h"
+
+#include <iostream>
+#include <limits>
+#include <random>
+
+using namespace std;
+
+static const int RANDOM_STEPS = 300;
+static const int VIEWS_PER_STEP = 4;
+
+static string draw(const Scheduler& scheduler, int view, int date) {
+    Renderer frame;
+    switch (view) {
+    case 0: scheduler.renderDaySchedule(date, frame); break;
+    case 1: scheduler.renderWeekSchedule(date, frame); break;
+    case 2: scheduler.renderMonthSchedule(date, frame); break;
+    default: scheduler.renderMonthCalendar(date, frame); break;
+    }
+    return frame.text();
+}
+
+void runRenderCacheTests(TestRunner& runner) {
+    runner.run("RenderCache, cached views match the views drawn from scratch", [](TestRunner& runner) {
+        // Each view is drawn twice after every random change and compared with the view of a scheduler that loads the
+        // calendar from its files, so its cache starts out empty
+        const char* titles[] = { "A", "B", "C", "D", "E" };
+        int today = Date(2030, 1, 1).toDayNumber();
+        mt19937 random(1);
+        string path = runner.dataPath("render-cache");
+        Scheduler scheduler(today, path);
+        string problem;
+        for (int step = 0; step < RANDOM_STEPS && problem.empty(); ++step) {
+            int operation = (int)(random() % 9);
+            int date = today + (int)(random() % 70);
+            string title = titles[random() % 5];
+            if (operation <= 2) {
+                int start = (int)(random() % 20);
+                RepeatType repeatType = (RepeatType)(random() % 5 == 0 ? 1 + random() % 2 : 0);
+                scheduler.trySchedule(date, Event(Title(title), Time(start, 0), Time(start, 30), repeatType), random() % 4 == 0);
+            }
+            else if (operation == 3) {
+                scheduler.tryCancel(date, title, random() % 2 == 0);
+            }
+            else if (operation == 4) {
+                scheduler.tryShift(date, title, today + (int)(random() % 70));
+            }
+            else if (operation == 5) {
+                scheduler.tryMarkDayOff(date);
+            }
+            else if (operation == 6) {
+                scheduler.tryUndo();
+            }
+            else if (operation == 7) {
+                scheduler.tryRedo();
+            }
+            else {
+                string name = "v" + to_string(random() % 3);
+                if (random() % 2 == 0) {
+                    scheduler.trySaveVersion(name);
+                }
+                else {
+                    scheduler.tryRestoreVersion(name);
+                }
+            }
+
+            CHECK(runner, scheduler.sync().isOk());
+            Scheduler reference(today, path, true);
+            for (int i = 0; i < VIEWS_PER_STEP && problem.empty(); ++i) {
+                int view = (int)(random() % 4);
+                int viewDate = today + (int)(random() % 70);
+                string first = draw(scheduler, view, viewDate);
+                string second = draw(scheduler, view, viewDate); // from the cache if the first one was not
+                if (first != draw(reference, view, viewDate) || second != first) {
+                    problem = "view " + to_string(view) + " of " + Date::fromDayNumber(viewDate).toString() + " differs at step " + to_string(step);
+                }
+            }
+        }
+        if (!problem.empty()) {
+            cerr << problem << "\n";
+        }
+        CHECK(runner, problem.empty());
+    });
+
+    runner.run("RenderCache, rejected commands keep the cached views", [](TestRunner& runner) {
+        Scheduler scheduler(numeric_limits<int>::min(), runner.dataPath("render-rejected"));
+        CHECK(runner, runCommands(scheduler, "schedule|2030-01-07|Standup|09:00|09:15|daily\nschedule|2030-01-15|Review|14:00|15:00|none\n"
+            "schedule|2030-02-20|Lunch|12:00|13:00|none\n") == "OK\nOK\nOK\n");
+        int date = Date(2030, 1, 15).toDayNumber();
+        string month = draw(scheduler, 2, date);
+        uint64_t built = scheduler.builtViews();
+
+        // Lunch is a known title that is not on these days, so the stored days and the series are looked up
+        string answers = runCommands(scheduler, "schedule|2030-01-15|Overlap|14:30|15:30|none\ncancel|2030-01-15|Lunch\n"
+            "cancel|2030-01-16|Lunch|all\nshift|2030-01-15|Lunch|2030-01-18\nshift|2030-01-15|Review|2030-01-15\n");
+        CHECK(runner, answers.find("OK") == string::npos);
+        CHECK(runner, draw(scheduler, 2, date) == month);
+        CHECK(runner, scheduler.builtViews() == built); // copied from the cache, not built again
+
+        CHECK(runner, runCommands(scheduler, "cancel|2030-01-15|Review\n") == "OK\n");
+        CHECK(runner, draw(scheduler, 2, date) != month);
+        CHECK(runner, scheduler.builtViews() == built + 1);
+    });
+}
@@ -0,0 +1,52 @@
+#include "Tests.h"
+#include "../Scheduler.h"
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+using namespace std;
+
+static bool replaceBytes(const string& path, const string& from, const string& to) { // the first occurrence only
+    string data = readFile(path);
+    size_t position = data.find(from);
+    if (position == string::npos) {
+        return false;
+    }
+    data.replace(position, from.size(), to);
+    ofstream(path, ios::binary | ios::trunc) << data;
+    return true;
+}
+
+void runSnapshotTests(TestRunner& runner) {
+    runner.run("Snapshot, an event time out of range rejects the file before anything is loaded", [](TestRunner& runner) {
+        string path = runner.dataPath("bad-time");
+        {
+            Scheduler scheduler(numeric_limits<int>::min(), path);
+            CHECK(runner, runCommands(scheduler, "schedule|2030-01-01|Early|09:00|09:30|none\nschedule|2030-06-01|Late|10:00|11:00|none\n") == "OK\nOK\n");
+            scheduler.compact();
+        }
+        remove((path + ".journal").c_str()); // only the snapshot is loaded
+
+        // 10:00 and 11:00 as the little-endian minutes of the record, the end becomes 25:00
+        CHECK(runner, replaceBytes(path + ".bin", string("\x58\x02\x94\x02", 4), string("\x58\x02\xdc\x05", 4)));
+        Scheduler scheduler(numeric_limits<int>::min(), path);
+        CHECK(runner, runCommands(scheduler, "view|2030-01-01\nview|2030-06-01\n") == "OK 0\nOK 0\n"); // not even the day of the first block
+    });
+
+    runner.run("Snapshot, overlapping events of a day reject the file before anything is loaded", [](TestRunner& runner) {
+        string path = runner.dataPath("overlap");
+        {
+            Scheduler scheduler(numeric_limits<int>::min(), path);
+            CHECK(runner, runCommands(scheduler, "schedule|2030-01-01|Early|09:00|09:30|none\n"
+                "schedule|2030-06-01|First|10:00|11:00|none\nschedule|2030-06-01|Second|11:00|12:00|none\n") == "OK\nOK\nOK\n");
+            scheduler.compact();
+        }
+        remove((path + ".journal").c_str());
+
+        // the second event starts at 10:30 instead of 11:00, inside the first one
+        CHECK(runner, replaceBytes(path + ".bin", string("\x94\x02\xd0\x02", 4), string("\x76\x02\xd0\x02", 4)));
+        Scheduler scheduler(numeric_limits<int>::min(), path);
+        CHECK(runner, runCommands(scheduler, "view|2030-01-01\nview|2030-06-01\n") == "OK 0\nOK 0\n");
+    });
+}
@@ -0,0 +1,69 @@
+#include "TestRunner.h"
+
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+TestRunner::TestRunner(const string& directory, const string& filter) {
+    this->directory = directory;
+    this->filter = filter;
+    this->testCount = 0;
+    this->failedTests = 0;
+    this->testFailed = false;
+}
+
+void TestRunner::removeScratchFiles() {
+    for (const string& path : scratchPaths) {
+        remove(path.c_str());
+    }
+    scratchPaths.clear();
+}
+
+void TestRunner::run(const string& name, const function<void(TestRunner&)>& test) {
+    if (!filter.empty() && name.find(filter) == string::npos) {
+        return;
+    }
+    testName = name;
+    testFailed = false;
+    ++testCount;
+    try {
+        test(*this);
+    }
+    catch (const exception& exception) { // a test that throws fails, the others still run
+        cerr << name << ": threw " << exception.what() << "\n";
+        testFailed = true;
+    }
+    removeScratchFiles();
+    if (testFailed) {
+        ++failedTests;
+    }
+    cout << (testFailed ? "FAIL " : "ok   ") << name << "\n";
+}
+
+void TestRunner::check(bool passed, const char* condition, const char* file, int line) {
+    if (!passed) {
+        cerr << testName << ": " << file << ":" << line << ": CHECK(" << condition << ") failed\n";
+        testFailed = true;
+    }
+}
+
+string TestRunner::dataPath(const string& name) {
+    string path = scratchPath(name);
+    for (const char* extension : { ".bin", ".journal" }) {
+        scratchPaths.push_back(path + extension);
+        remove(scratchPaths.back().c_str());
+    }
+    scratchPaths.push_back(path + ".txt");
+    ofstream(scratchPaths.back()); // an empty calendar, so the scheduler has nothing to complain about
+    return path;
+}
+
+string TestRunner::scratchPath(const string& name) {
+    string path = directory + "/test-" + name;
+    remove(path.c_str());
+    scratchPaths.push_back(path);
+    return path;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Runs the regression tests one after another and reports each failed check with its file and line. A failed check
+ * does not stop its test, so that one run shows every check that fails:
+ *
+ *     runner.run("BulkImporter, day off cancels the series", [](TestRunner& runner) {
+ *         CHECK(runner, day.isDayOff);
+ *     });
+ *
+ * Every test gets its own data path in the scratch directory, emptied before and after the test.
+ */
+class TestRunner {
+private:
+    string directory; // scratch files of the tests
+    string filter; // only the tests whose name contains it are run
+    string testName; // the test that is running
+    vector<string> scratchPaths; // files the running test asked for, removed when it ends
+    int testCount;
+    int failedTests;
+    bool testFailed;
+
+    void removeScratchFiles();
+
+public:
+    TestRunner(const string& directory = ".", const string& filter = "");
+
+    void run(const string& name, const function<void(TestRunner&)>& test);
+    void check(bool passed, const char* condition, const char* file, int line);
+
+    string dataPath(const string& name); // data path of a calendar that starts out empty, its .txt exists so nothing is loaded
+    string scratchPath(const string& name); // a file name in the scratch directory, no file there yet
+
+    int failures() const { return failedTests; }
+    int count() const { return testCount; }
+};
+
+#define CHECK(runner, condition) (runner).check((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,62 @@
+#include "Tests.h"
+#include "../CommandProcessor.h"
+#include "../Scheduler.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+using namespace std;
+
+/*
+ * Regression tests of the calendar:
+ *
+ *     Tests [--filter text] [--dir path]      runs the tests whose name contains the text, scratch files go to the path
+ *
+ * Prints one line per test and exits with 1 if any of them failed.
+ */
+
+string readFile(const string& path) {
+    ifstream file(path, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+string runCommands(Scheduler& scheduler, const string& commands) {
+    CommandProcessor processor(scheduler);
+    string answers;
+    size_t lineStart = 0;
+    while (lineStart < commands.size()) {
+        size_t lineEnd = commands.find('\n', lineStart);
+        processor.execute(string_view(commands).substr(lineStart, lineEnd - lineStart), answers);
+        lineStart = lineEnd + 1;
+    }
+    return answers;
+}
+
+int main(int argc, char* argv[]) {
+    string filter;
+    string directory = ".";
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if ((option == "--filter" || option == "--dir") && i + 1 < argc) {
+            (option == "--filter" ? filter : directory) = argv[++i];
+        }
+        else {
+            cerr << "Usage: Tests [--filter text] [--dir path]\n";
+            return 2;
+        }
+    }
+
+    TestRunner runner(directory, filter);
+    runBatchTests(runner);
+    runCommandTests(runner);
+    runConcurrencyTests(runner);
+    runDateTests(runner);
+    runImportTests(runner);
+    runRenderCacheTests(runner);
+    runSnapshotTests(runner);
+    runUndoTests(runner);
+
+    cout << runner.count() - runner.failures() << " of " << runner.count() << " tests passed\n";
+    return runner.failures() == 0 ? 0 : 1;
+}
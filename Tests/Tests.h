@@ -0,0 +1,23 @@
+#pragma once
+
+#include "TestRunner.h"
+
+#include <string>
+
+using namespace std;
+
+class Scheduler;
+
+// The tests of each part of the calendar, see the .cpp file of the same name
+void runBatchTests(TestRunner& runner);
+void runCommandTests(TestRunner& runner);
+void runConcurrencyTests(TestRunner& runner);
+void runDateTests(TestRunner& runner);
+void runImportTests(TestRunner& runner);
+void runRenderCacheTests(TestRunner& runner);
+void runSnapshotTests(TestRunner& runner);
+void runUndoTests(TestRunner& runner);
+
+// Helpers of the tests, in Tests.cpp
+string readFile(const string& path);
+string runCommands(Scheduler& scheduler, const string& commands); // the answers of the batch commands, one line per command
@@ -0,0 +1,132 @@
+#include "Tests.h"
+#include "../Scheduler.h"
+#include "../Date.h"
+
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static const int RANDOM_STEPS = 900;
+static const int SEEDS = 3;
+
+static string fingerprint(Scheduler& scheduler, const string& path) { // the whole calendar in the text format
+    scheduler.saveEventsTo_txt(path);
+    return readFile(path);
+}
+
+void runUndoTests(TestRunner& runner) {
+    runner.run("Scheduler, undo, redo and restore go back to the calendar as it was", [](TestRunner& runner) {
+        // Random changes, undos, redos and versions, each checked against the texts of the calendar after every change
+        // that was made, while a reader keeps drawing days from the published copies
+        const char* titles[] = { "A", "B", "C", "D", "E" };
+        int today = Date(2030, 1, 1).toDayNumber();
+        string textPath = runner.scratchPath("undo.txt");
+        for (int seed = 1; seed <= SEEDS; ++seed) {
+            mt19937 random(seed);
+            string path = runner.dataPath("undo-" + to_string(seed));
+            string problem;
+            int step = 0;
+            string finalText;
+            {
+                Scheduler scheduler(today, path);
+                scheduler.enableConcurrentReads();
+                atomic<bool> stopping(false);
+                thread reader([&]() {
+                    while (!stopping.load(memory_order_relaxed)) {
+                        for (int day = 0; day < 60; ++day) {
+                            scheduler.daySchedule(today + day);
+                        }
+                    }
+                });
+
+                vector<string> history{ fingerprint(scheduler, textPath) }; // the calendar after each change, undo moves back through it
+                size_t current = 0;
+                map<string, string> versions;
+                for (; step < RANDOM_STEPS && problem.empty(); ++step) {
+                    int operation = (int)(random() % 10);
+                    int date = today + (int)(random() % 60);
+                    string title = titles[random() % 5];
+                    bool changed = false;
+                    if (operation <= 2) {
+                        int start = (int)(random() % 20);
+                        RepeatType repeatType = (RepeatType)(random() % 5 == 0 ? 1 + random() % 2 : 0);
+                        Expected<vector<Conflict>> conflicts = scheduler.trySchedule(date, Event(Title(title), Time(start, 0), Time(start, 30), repeatType), random() % 4 == 0);
+                        changed = conflicts.hasValue() && conflicts->empty();
+                    }
+                    else if (operation == 3) {
+                        changed = scheduler.tryCancel(date, title, random() % 2 == 0).isOk();
+                    }
+                    else if (operation == 4) {
+                        changed = scheduler.tryShift(date, title, today + (int)(random() % 60)).isOk();
+                    }
+                    else if (operation == 5) {
+                        changed = scheduler.tryMarkDayOff(date).isOk();
+                    }
+                    else if (operation == 6 || operation == 7) {
+                        bool undone = scheduler.tryUndo().isOk();
+                        if (undone != (current > 0)) {
+                            problem = "undo was " + string(undone ? "" : "not ") + "possible";
+                        }
+                        else if (undone && fingerprint(scheduler, textPath) != history[--current]) {
+                            problem = "undo did not go back to the calendar before the change";
+                        }
+                        continue;
+                    }
+                    else if (operation == 8) {
+                        bool redone = scheduler.tryRedo().isOk();
+                        if (redone != (current + 1 < history.size())) {
+                            problem = "redo was " + string(redone ? "" : "not ") + "possible";
+                        }
+                        else if (redone && fingerprint(scheduler, textPath) != history[++current]) {
+                            problem = "redo did not make the change again";
+                        }
+                        continue;
+                    }
+                    else {
+                        string name = "v" + to_string(random() % 3);
+                        if (random() % 2 == 0) {
+                            scheduler.trySaveVersion(name);
+                            versions[name] = history[current];
+                            continue;
+                        }
+                        bool restored = scheduler.tryRestoreVersion(name).isOk();
+                        if (restored != (versions.count(name) > 0)) {
+                            problem = "restore was " + string(restored ? "" : "not ") + "possible";
+                            continue;
+                        }
+                        changed = restored;
+                        if (restored && fingerprint(scheduler, textPath) != versions[name]) {
+                            problem = "restore did not go back to the version";
+                            continue;
+                        }
+                    }
+
+                    string text = fingerprint(scheduler, textPath);
+                    if (changed) { // a change, and a restore, drop the undone ones
+                        history.resize(current + 1);
+                        history.push_back(text);
+                        ++current;
+                    }
+                    else if (text != history[current]) {
+                        problem = "a rejected change altered the calendar";
+                    }
+                }
+                stopping = true;
+                reader.join();
+                finalText = history[current];
+            }
+            if (!problem.empty()) {
+                cerr << "seed " << seed << ", step " << step - 1 << ": " << problem << "\n";
+            }
+            CHECK(runner, problem.empty());
+
+            Scheduler reloaded(today, path, true); // the journal and the snapshot hold the calendar as it was left
+            CHECK(runner, fingerprint(reloaded, textPath) == finalText);
+        }
+    });
+}
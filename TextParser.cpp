@@ -0,0 +1,148 @@
+#include "TextParser.h"
+#include "Date.h"
+#include "RecurrenceRule.h"
+#include "ParseExceptions.h"
+
+#include <charconv>
+#include <cstring>
+
+using namespace std;
+
+TextParser::TextParser(string_view text) {
+    this->position = text.data();
+    this->end = text.data() + text.size();
+    this->lineStart = position;
+    this->lineEnd = position;
+    this->lineNumber = 0;
+}
+
+bool TextParser::next(TextLine& line) {
+    while (position < end) {
+        lineStart = position;
+        lineEnd = static_cast<const char*>(memchr(position, '\n', (size_t)(end - position)));
+        if (lineEnd == nullptr) {
+            lineEnd = end; // the last line has no line break
+        }
+        position = (lineEnd < end) ? lineEnd + 1 : end;
+        ++lineNumber;
+
+        if (lineEnd > lineStart && lineEnd[-1] == '\r') { // files written on Windows
+            --lineEnd;
+        }
+        if (lineEnd == lineStart) {
+            continue;
+        }
+        parseLine(string_view(lineStart, (size_t)(lineEnd - lineStart)), line);
+        return true;
+    }
+    return false;
+}
+
+void TextParser::parseLine(string_view rest, TextLine& line) const {
+    string_view field = nextField(rest, '|');
+    if (!parseDate(field, line.date)) {
+        fail(1, field.data());
+    }
+
+    field = requireField(rest);
+    line.isDayOff = (field == "off");
+    if (line.isDayOff) {
+        return; // anything after "off" is ignored
+    }
+    if (field.empty()) {
+        fail(4, field.data());
+    }
+    line.title = field;
+
+    field = requireField(rest);
+    if (!Time::tryParse(field, line.startTime)) {
+        fail(2, field.data());
+    }
+    field = requireField(rest);
+    if (!Time::tryParse(field, line.endTime)) {
+        fail(2, field.data());
+    }
+    if (line.endTime < line.startTime) {
+        fail(5, field.data());
+    }
+    line.repeatType = repeatTypeFromString(requireField(rest));
+
+    line.hasLimits = (rest.data() != nullptr);
+    line.lastDay = RecurrenceRule::NO_END;
+    line.exceptions = string_view();
+    line.period = 0;
+    if (!line.hasLimits) {
+        return;
+    }
+
+    field = nextField(rest, '|'); // an empty last date means the series never ends
+    if (!field.empty() && !parseDate(field, line.lastDay)) {
+        fail(1, field.data());
+    }
+    if (rest.data() == nullptr) {
+        return;
+    }
+    line.exceptions = nextField(rest, '|');
+    string_view dates = line.exceptions;
+    while (dates.data() != nullptr) { // check the cancelled dates here so that forEachDate() can skip the checks
+        field = nextField(dates, ',');
+        int exception = 0;
+        if (!field.empty() && !parseDate(field, exception)) {
+            fail(1, field.data());
+        }
+    }
+    if (rest.data() == nullptr) {
+        return;
+    }
+
+    field = rest; // the days between two occurrences, written only when they differ from the repeat type
+    line.period = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9' || line.period > 100000) {
+            fail(7, field.data());
+        }
+        line.period = line.period * 10 + (c - '0');
+    }
+    if (line.period == 0) {
+        fail(7, field.data());
+    }
+}
+
+string_view TextParser::requireField(string_view& rest) const {
+    if (rest.data() == nullptr) {
+        fail(3, lineEnd);
+    }
+    return nextField(rest, '|');
+}
+
+void TextParser::fail(int code, const char* at) const {
+    throw ParseExceptions(code, lineNumber, (int)(at - lineStart) + 1);
+}
+
+string_view TextParser::nextField(string_view& rest, char separator) {
+    size_t separatorPosition = rest.find(separator);
+    string_view field = rest.substr(0, separatorPosition);
+    if (separatorPosition == string_view::npos) {
+        rest = string_view(); // no data marks that there is no further field, unlike an empty field
+    }
+    else {
+        rest.remove_prefix(separatorPosition + 1);
+    }
+    return field;
+}
+
+bool TextParser::parseDate(string_view text, int& dayNumber) {
+    Date date;
+    if (Date::tryParse(text, date)) {
+        dayNumber = date.toDayNumber();
+        return true;
+    }
+
+    int legacyDay = 0; // Files written before multi-month support only store the day of July 2024
+    auto result = from_chars(text.data(), text.data() + text.size(), legacyDay);
+    if (result.ec != errc() || result.ptr != text.data() + text.size() || legacyDay < 1 || legacyDay > 31) {
+        return false;
+    }
+    dayNumber = Date(2024, 7, legacyDay).toDayNumber();
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string_view>
+#include "Event.h"
+#include "Time.h"
+
+using namespace std;
+
+struct TextLine { // One line of the event text format. The views point into the buffer that is being parsed
+    int date; // day number
+    bool isDayOff;
+    string_view title;
+    Time startTime;
+    Time endTime;
+    RepeatType repeatType;
+    bool hasLimits; // a series line that carries its last date and its cancelled dates
+    int lastDay; // RecurrenceRule::NO_END if the series never ends
+    string_view exceptions; // comma separated dates, already checked by the parser
+    int period; // days between two occurrences, 0 for the period of the repeat type
+};
+
+class TextParser { // Reads the event text format straight out of one buffer, without allocating anything per line
+private:
+    const char* position; // start of the next line
+    const char* end;
+    const char* lineStart;
+    const char* lineEnd;
+    int lineNumber;
+
+    void parseLine(string_view rest, TextLine& line) const;
+    string_view requireField(string_view& rest) const; // the next '|' field, or an error if the line has ended
+    [[noreturn]] void fail(int code, const char* at) const; // throws ParseExceptions with the line and the column of the position
+
+public:
+    TextParser(string_view text);
+
+    bool next(TextLine& line); // false once every line is read, empty lines are skipped
+    int currentLine() const { return lineNumber; }
+
+    static string_view nextField(string_view& rest, char separator); // split off the text before the separator, rest has no data once the last field is taken
+    static bool parseDate(string_view text, int& dayNumber); // YYYY-MM-DD, or the day of July 2024 written by older files
+
+    template <typename Function>
+    static void forEachDate(string_view dates, Function function) { // visit the day numbers of a comma separated list
+        while (dates.data() != nullptr) {
+            string_view field = nextField(dates, ',');
+            int dayNumber = 0;
+            if (!field.empty() && parseDate(field, dayNumber)) {
+                function(dayNumber);
+            }
+        }
+    }
+};
@@ -0,0 +1,95 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = max(1, (int)thread::hardware_concurrency()); // hardware_concurrency() may return 0 if it is unknown
+    }
+    this->threadCount = threadCount;
+    this->stopping = false;
+
+    for (int i = 1; i < threadCount; ++i) { // the thread that calls parallelFor() is the last worker
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            taskReady.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // stopping and nothing left to run
+            }
+            task = move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int)>& body) {
+    if (count <= 0) {
+        return;
+    }
+
+    atomic<int> nextIndex(0); // iterations are handed out one at a time so that uneven ones balance out
+    exception_ptr firstError;
+    mutex errorMutex;
+    auto work = [&]() {
+        for (int i = nextIndex++; i < count; i = nextIndex++) {
+            try {
+                body(i);
+            }
+            catch (...) {
+                lock_guard<mutex> lock(errorMutex);
+                if (!firstError) {
+                    firstError = current_exception();
+                }
+            }
+        }
+    };
+
+    int helpers = min(count, threadCount) - 1;
+    int running = helpers;
+    mutex doneMutex;
+    condition_variable done;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        for (int i = 0; i < helpers; ++i) {
+            tasks.push_back([&]() {
+                work();
+                lock_guard<mutex> doneLock(doneMutex);
+                if (--running == 0) {
+                    done.notify_one();
+                }
+            });
+        }
+    }
+    taskReady.notify_all();
+
+    work();
+    unique_lock<mutex> lock(doneMutex);
+    done.wait(lock, [&running]() { return running == 0; });
+
+    if (firstError) {
+        rethrow_exception(firstError);
+    }
+}
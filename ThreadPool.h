@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ThreadPool { // Fixed set of worker threads that share the iterations of parallelFor() with the calling thread
+private:
+    vector<thread> workers;
+    deque<function<void()>> tasks;
+    mutex queueMutex;
+    condition_variable taskReady;
+    bool stopping;
+    int threadCount;
+
+    void workerLoop();
+
+public:
+    ThreadPool(int threadCount = 0); // threads that do the work, counting the caller; 0 means one per hardware thread
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return threadCount; }
+
+    // Runs body(0) ... body(count - 1) and waits for all of them, then rethrows the first exception. Must not be nested inside a body.
+    void parallelFor(int count, const function<void(int)>& body);
+};
@@ -1,39 +1,58 @@
 #include "Time.h"
 #include "TimeExceptions.h"
 
-#include <sstream>
-#include <iostream>
-
-
-Time::Time(int hour, int minute) {
-    this->hour = hour;
-    this->minute = minute;
-
-    if (hour < 0 || hour >= 24 || minute < 0 || minute >= 60) {
-        throw TimeExceptions(1);
-    }
+void Time::writeTo(char* buffer) const { // write the time as HH:MM into the buffer
+    int hour = getHour();
+    int minute = getMinute();
+    buffer[0] = (char)('0' + hour / 10);
+    buffer[1] = (char)('0' + hour % 10);
+    buffer[2] = ':';
+    buffer[3] = (char)('0' + minute / 10);
+    buffer[4] = (char)('0' + minute % 10);
 }
 
-bool Time::isSmallerComparedTo(Time& comparisonTime) const { // check if the time is smaller than another time
-    return (hour < comparisonTime.hour) || (hour == comparisonTime.hour && minute < comparisonTime.minute);
+string Time::toString() const { // return the time as a string, short enough to stay in the small string buffer
+    char buffer[5];
+    writeTo(buffer);
+    return string(buffer, 5);
 }
 
-bool Time::isLargerComparedTo(Time& comparisonTime) const { // check if the time is larger than another time
-    return (hour > comparisonTime.hour) || (hour == comparisonTime.hour && minute > comparisonTime.minute);
+void Time::fromString(string_view timeString) {
+    *this = parse(timeString).valueOrThrow();
 }
 
-string Time::toString() const { // return the time as a string
-    return (hour < 10 ? "0" : "") + to_string(hour) + ":" + (minute < 10 ? "0" : "") + to_string(minute);
+Expected<Time> Time::parse(string_view timeString) {
+    Time time;
+    if (!tryParse(timeString, time)) {
+        return Status(ErrorKind::Time, 1);
+    }
+    return time;
 }
 
-void Time::fromString(string& timeString) {
-    stringstream timeStream(timeString);  // Here is one way that we usd stringstream where to convert stream which enable us to use stream managing tools in cpp such as >>
-    char separator;
+bool Time::tryParse(string_view timeString, Time& time) { // parse without going through a stream
+    int hour = 0, minute = 0;
+    size_t position = 0;
+    int digits = 0;
 
-    timeStream >> hour >> separator >> minute;
-    if (hour < 0 || hour >= 24 || minute < 0 || minute >= 60) {
-        throw TimeExceptions(1);
+    while (position < timeString.size() && digits < 2 && timeString[position] >= '0' && timeString[position] <= '9') {
+        hour = hour * 10 + (timeString[position++] - '0');
+        ++digits;
     }
+    if (digits == 0 || position >= timeString.size() || timeString[position++] != ':') {
+        return false;
+    }
+
+    digits = 0;
+    while (position < timeString.size() && digits < 2 && timeString[position] >= '0' && timeString[position] <= '9') {
+        minute = minute * 10 + (timeString[position++] - '0');
+        ++digits;
+    }
+    if (digits == 0 || position != timeString.size() || hour >= 24 || minute >= 60) {
+        return false;
+    }
+
+    time = Time(hour, minute);
+    return true;
 
     /*
      * Referred from the GitHub repository: Appointment-Booking https://github.com/pgagliano/Appointment-Booking/blob/master/myTime.cpp
@@ -1,27 +1,49 @@
 #pragma once
 
-#include <iostream>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "TimeExceptions.h"
+#include "Status.h"
 
 using namespace std;
 
-class Time { // Class for the Time 
+class Time { // Class for the Time, stored as the number of minutes since midnight
 private:
-    int hour;
-    int minute;
+    uint16_t minutes;
 public:
 
-    Time(int hour = 0, int minute = 0);
+    constexpr Time(int hour = 0, int minute = 0) : minutes((uint16_t)(hour * 60 + minute)) {
+        if (hour < 0 || hour >= 24 || minute < 0 || minute >= 60) {
+            throw TimeExceptions(1);
+        }
+    }
 
-    bool isSmallerComparedTo(Time& comparisonTime) const;
+    constexpr int getHour() const { return minutes / 60; }
 
-    bool isLargerComparedTo(Time& comparisonTime) const;
+    constexpr int getMinute() const { return minutes % 60; }
+
+    constexpr int toMinutes() const { return minutes; }
+
+    static constexpr Time fromMinutes(int minutes) { return Time(minutes / 60, minutes % 60); }
+
+    friend constexpr bool operator==(Time first, Time second) { return first.minutes == second.minutes; }
+    friend constexpr bool operator!=(Time first, Time second) { return first.minutes != second.minutes; }
+    friend constexpr bool operator<(Time first, Time second) { return first.minutes < second.minutes; }
+    friend constexpr bool operator>(Time first, Time second) { return first.minutes > second.minutes; }
+    friend constexpr bool operator<=(Time first, Time second) { return first.minutes <= second.minutes; }
+    friend constexpr bool operator>=(Time first, Time second) { return first.minutes >= second.minutes; }
+
+    void writeTo(char* buffer) const; // writes the 5 characters of HH:MM, without a terminating null
 
     string toString() const;
 
-    void fromString(string& timeString);
+    void fromString(string_view timeString);
+
+    static bool tryParse(string_view timeString, Time& time); // H:MM or HH:MM, returns false instead of throwing
+
+    static Expected<Time> parse(string_view timeString); // the time, or TimeExceptions code 1
     /*
      * Referred from the GitHub repository: Appointment-Booking https://github.com/pgagliano/Appointment-Booking/blob/master/myTime.cpp
      * Author: Patrick Gagliano
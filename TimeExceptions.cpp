@@ -1,11 +1,14 @@
 #include "TimeExceptions.h"
 
 TimeExceptions::TimeExceptions(int code) : Exceptions(code) { // Constructor for the TimeExceptions class
-    switch (errorCode) {
+    errorMessage = message(code);
+}
+
+const char* TimeExceptions::message(int code) {
+    switch (code) {
     case 1:
-        errorMessage = "Invalid time format";
-        break;
+        return "Invalid time format";
     default:
-        errorMessage = "Time error";
+        return "Time error";
     }
 }
\ No newline at end of file
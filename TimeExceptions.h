@@ -5,4 +5,5 @@
 class TimeExceptions : public Exceptions { // Derived class for the TimeExceptions
 public:
 	TimeExceptions(int code);
+	static const char* message(int code);
 };
\ No newline at end of file